@@ -23,6 +23,17 @@ def config( # pylint: disable=too-many-arguments
         idle_threshold=100,
         fifo_depth=4,
         random=False,
+        fast_forward=False,
+        dram_threads=1,
+        core_tck=None,
+        dram_latency_csv=None,
+        dram_samples=None,
+        dram_sample_interval=1000,
+        dram_trace=None,
+        dram_coalesce=None,
+        dram_coalesce_window=8,
+        dram_fast=False,
+        dram_detailed=None,
         enable_cache=True):
     '''The helper function to dump the default configuration of elaboration.'''
     res = {
@@ -36,6 +47,17 @@ def config( # pylint: disable=too-many-arguments
         'idle_threshold': idle_threshold,
         'fifo_depth': fifo_depth,
         'random': random,
+        'fast_forward': fast_forward,
+        'dram_threads': dram_threads,
+        'core_tck': core_tck,
+        'dram_latency_csv': dram_latency_csv,
+        'dram_samples': dram_samples,
+        'dram_sample_interval': dram_sample_interval,
+        'dram_trace': dram_trace,
+        'dram_coalesce': dram_coalesce,
+        'dram_coalesce_window': dram_coalesce_window,
+        'dram_fast': dram_fast,
+        'dram_detailed': dram_detailed,
         'enable_cache': enable_cache
     }
     return res.copy()
@@ -72,6 +94,17 @@ def _generate_cache_key(sys_name: str, config_dict: dict) -> str:
         'idle_threshold': config_dict.get('idle_threshold'),
         'fifo_depth': config_dict.get('fifo_depth'),
         'random': config_dict.get('random', False),
+        'fast_forward': config_dict.get('fast_forward', False),
+        'dram_threads': config_dict.get('dram_threads', 1),
+        'core_tck': config_dict.get('core_tck'),
+        'dram_latency_csv': config_dict.get('dram_latency_csv'),
+        'dram_samples': config_dict.get('dram_samples'),
+        'dram_sample_interval': config_dict.get('dram_sample_interval', 1000),
+        'dram_trace': config_dict.get('dram_trace'),
+        'dram_coalesce': config_dict.get('dram_coalesce'),
+        'dram_coalesce_window': config_dict.get('dram_coalesce_window', 8),
+        'dram_fast': config_dict.get('dram_fast', False),
+        'dram_detailed': config_dict.get('dram_detailed'),
     }
 
     # Create a stable string representation and hash it
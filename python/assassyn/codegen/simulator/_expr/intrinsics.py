@@ -9,6 +9,7 @@ This module contains helper functions to generate simulator code for intrinsic o
 from ....ir.expr.intrinsic import PureIntrinsic, Intrinsic, ExternalIntrinsic
 from ....utils import namify
 from ..node_dumper import dump_rval_ref
+from ..utils import dtype_to_rust_type
 
 
 def _codegen_fifo_peek(node, module_ctx):
@@ -49,9 +50,19 @@ def _codegen_get_mem_resp(node, module_ctx):
     """Generate code for GET_MEM_RESP intrinsic."""
     dram_module = node.args[0]
     dram_name = namify(dram_module.name)
+    if dram_module.width <= 64:
+        # A word of up to 64 bits reads as its integer type, without a BigUint
+        rust_ty = dtype_to_rust_type(node.dtype)
+        return f"ValueCastTo::<{rust_ty}>::cast(&le_word(&sim.{dram_name}_response.data))"
     return f"BigUint::from_bytes_le(&sim.{dram_name}_response.data)"
 
 
+def _codegen_mem_free_slots(node, module_ctx):
+    """Generate code for MEM_FREE_SLOTS intrinsic."""
+    dram_name = namify(node.args[0].name)
+    return f"unsafe {{ sim.mi_{dram_name}.queue_free_slots() }}"
+
+
 def _codegen_external_output_read(node, module_ctx, **_kwargs):
     """Generate code for EXTERNAL_OUTPUT_READ intrinsic.
 
@@ -90,6 +101,7 @@ _PURE_INTRINSIC_DISPATCH = {
     PureIntrinsic.MODULE_TRIGGERED: _codegen_module_triggered,
     PureIntrinsic.HAS_MEM_RESP: _codegen_has_mem_resp,
     PureIntrinsic.GET_MEM_RESP: _codegen_get_mem_resp,
+    PureIntrinsic.MEM_FREE_SLOTS: _codegen_mem_free_slots,
     PureIntrinsic.EXTERNAL_OUTPUT_READ: _codegen_external_output_read,
 }
 
@@ -135,19 +147,17 @@ def _codegen_send_read_request(node, module_ctx):
     return f"""if {re_val} {{
                         unsafe {{
                             let mem_interface = &sim.mi_{dram_name};
-                            let success = mem_interface.send_request(
+                            let id = mem_interface.submit(
                                 {addr_val} as i64,
                                 false,
-                                crate::modules::{dram_name}::callback_of_{dram_name},
-                                sim as *const _ as *mut _,
+                                None,
+                                None,
+                                std::ptr::null_mut(),
                             );
-                            if success {{
-                                sim.request_stamp_map_table.insert(
-                                    {addr_val} as i64,
-                                    sim.stamp,
-                                );
+                            if let Some(id) = id {{
+                                sim.{dram_name}_outstanding.insert(id, sim.stamp);
                             }}
-                            success
+                            id.is_some()
                         }}
                     }} else {{
                         false
@@ -159,20 +169,27 @@ def _codegen_send_write_request(node, module_ctx):
     dram_module = node.args[0]
     we = node.args[1]
     addr = node.args[2]
-    data = node.args[3]  # pylint: disable=unused-variable
+    data = node.args[3]
     dram_name = namify(dram_module.name)
     we_val = dump_rval_ref(module_ctx, we)
     addr_val = dump_rval_ref(module_ctx, addr)
+    data_val = dump_rval_ref(module_ctx, data)
     return f"""if {we_val} {{
                         unsafe {{
                             let mem_interface = &sim.mi_{dram_name};
-                            let success = mem_interface.send_request(
+                            let mut data = ValueCastTo::<BigUint>::cast(&{data_val}).to_bytes_le();
+                            data.resize(mem_interface.word_bytes(), 0);
+                            let id = mem_interface.submit(
                                 {addr_val} as i64,
                                 true,
-                                crate::modules::{dram_name}::callback_of_{dram_name},
-                                sim as *const _ as *mut _,
+                                Some(&data),
+                                None,
+                                std::ptr::null_mut(),
                             );
-                            success
+                            if let Some(id) = id {{
+                                sim.{dram_name}_outstanding.insert(id, sim.stamp);
+                            }}
+                            id.is_some()
                         }}
                     }} else {{
                         false
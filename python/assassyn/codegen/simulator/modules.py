@@ -171,35 +171,27 @@ use std::ffi::c_void;
 """)
 
                 if isinstance(module, DRAM):
-                    module_fd.write(f"""pub extern "C" fn callback_of_{module_name}(
-    req: *mut Request, ctx: *mut c_void) {{
-    unsafe {{
-        let req = &*req;
-        let sim: &mut Simulator = &mut *(ctx as *mut Simulator);
-        let cycles = (req.depart - req.arrive) as usize;
-        let stamp = sim.request_stamp_map_table
-            .remove(&req.addr)
-            .unwrap_or_else(|| sim.stamp);
-
-        if req.type_id == 0 {{
-            // Read response
-            sim.{module_name}_response.valid = true;
-            sim.{module_name}_response.addr = req.addr as usize;
-            sim.{module_name}_response.data = vec![
-                (req.addr as u8) & 0xFF,
-                ((req.addr >> 8) as u8) & 0xFF,
-                ((req.addr >> 16) as u8) & 0xFF,
-                ((req.addr >> 24) as u8) & 0xFF
-            ];
-            sim.{module_name}_response.read_succ = true;
-            sim.{module_name}_response.is_write = false;
-        }} else {{
-            // Write response
-            sim.{module_name}_response.valid = true;
-            sim.{module_name}_response.addr = req.addr as usize;
-            sim.{module_name}_response.write_succ = true;
-            sim.{module_name}_response.is_write = true;
-        }}
+                    module_fd.write(f"""pub fn response_of_{module_name}(
+    sim: &mut Simulator, done: &Completion, data: &[u8]) {{
+    let cycles = done.latency as usize;
+    let stamp = sim.{module_name}_outstanding
+        .remove(done.id)
+        .unwrap_or(sim.stamp);
+
+    if !done.is_write {{
+        // Read response
+        sim.{module_name}_response.valid = true;
+        sim.{module_name}_response.addr = done.addr as usize;
+        sim.{module_name}_response.data.clear();
+        sim.{module_name}_response.data.extend_from_slice(data);
+        sim.{module_name}_response.read_succ = true;
+        sim.{module_name}_response.is_write = false;
+    }} else {{
+        // Write response
+        sim.{module_name}_response.valid = true;
+        sim.{module_name}_response.addr = done.addr as usize;
+        sim.{module_name}_response.write_succ = true;
+        sim.{module_name}_response.is_write = true;
     }}
 }}
 
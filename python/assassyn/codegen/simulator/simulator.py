@@ -11,6 +11,8 @@ from ...ir.expr import Bind
 from ...ir.module import Downstream, Module
 from ...ir.module.external import ExternalSV
 from ...ir.memory.sram import SRAM
+from ...ir.memory.dram import DRAM
+from ...ir.memory.dram_config import DRAMConfig
 from ...ir.memory.base import MemoryBase
 from .external import (
     collect_external_classes,
@@ -19,7 +21,7 @@ from .external import (
     gather_expr_validities,
     is_stub_external,
 )
-from ...utils import namify, repo_path
+from ...utils import namify
 from .port_mapper import get_port_manager
 from ...utils.enforce_type import enforce_type
 
@@ -41,7 +43,6 @@ def analyze_and_register_ports(sys: SysBuilder) -> None:
     # pylint: disable=import-outside-toplevel
     from ...ir.expr.array import ArrayWrite
     from ...ir.visitor import Visitor
-    from ...ir.memory.dram import DRAM
 
     manager = get_port_manager()
     dram_modules = []
@@ -69,6 +70,127 @@ def analyze_and_register_ports(sys: SysBuilder) -> None:
     return manager, dram_modules
 
 
+@enforce_type
+def can_fast_forward(sys: SysBuilder) -> bool:
+    """Check if idle cycles of the system can be skipped without evaluating them.
+
+    An idle cycle, where no module is triggered and no DRAM response arrives,
+    leaves the simulator state untouched, so the next idle cycle behaves the
+    same. This does not hold if a module reads the cycle counter, or if an
+    external module is clocked every cycle.
+
+    Args:
+        sys: The Assassyn system builder
+
+    Returns:
+        True if the generated simulator may fast-forward over idle cycles
+    """
+    # pylint: disable=import-outside-toplevel
+    from ...ir.expr.intrinsic import PureIntrinsic
+    from ...ir.visitor import Visitor
+
+    reads_cycle = []
+
+    class CurrentCycleVisitor(Visitor):
+        """Visitor that finds reads of the current cycle."""
+
+        def visit_expr(self, node):
+            """Record `current_cycle()` intrinsics."""
+            if isinstance(node, PureIntrinsic) and node.opcode == PureIntrinsic.CURRENT_CYCLE:
+                reads_cycle.append(node)
+
+    CurrentCycleVisitor().visit_system(sys)
+    has_external = any(isinstance(m, ExternalSV) for m in sys.modules + sys.downstreams)
+    return not reads_cycle and not has_external and not collect_external_intrinsics(sys)
+
+
+def dram_config_literal(dram: DRAM, config) -> str:
+    """The Rust string literal passed to `MemoryInterface::init` for `dram`.
+
+    A `DRAMConfig` and inline YAML are embedded as a raw string, so the
+    simulator does not depend on any file of the source tree. A path to a
+    YAML file is resolved against `resource_base`, as `init_file` is.
+    """
+    if isinstance(dram.config, DRAMConfig):
+        text = dram.config.to_yaml()
+    elif '\n' in dram.config:
+        text = dram.config
+    else:
+        path = os.path.join(config.get('resource_base', '.'), dram.config)
+        return '"' + os.path.normpath(path).replace('\\', '\\\\').replace('"', '\\"') + '"'
+    hashes = '#'
+    while f'"{hashes}' in text:
+        hashes += '#'
+    return f'r{hashes}"{text}"{hashes}'
+
+
+def dump_fast_forward(sys: SysBuilder, dram_modules, fd):
+    """Generate `Simulator::fast_forward`, which skips idle cycles.
+
+    It is called after a cycle in which no module was triggered, and skips as many
+    of the following cycles as are guaranteed to be idle as well, up to `budget`.
+    A cycle stays idle until a pending event becomes valid or a DRAM response
+    arrives. A single DRAM in flight is advanced to its first completion with
+    `skip_to`; idle DRAMs only move their clock. With more than one DRAM in
+    flight the completion order is unknown, so nothing is skipped. Nothing is
+    skipped either while a DRAM response is pending, as the next cycle reads
+    it, or after a cycle in which a downstream ran. A Driver stalled in
+    `wait_until` does not prevent skipping: its stale event only stays at the
+    front of its queue.
+    """
+    fd.write("  pub fn fast_forward(&mut self, budget: usize) -> usize {\n")
+    pending = [f"self.{namify(dram.name)}_response.valid" for dram in dram_modules]
+    pending += [f"self.{namify(module.name)}_triggered" for module in sys.downstreams
+                if not is_stub_external(module)]
+    if pending:
+        fd.write("    // Skipped cycles would drop a pending response, or delay it.\n")
+        fd.write(f"    if {' || '.join(pending)} {{\n")
+        fd.write("      return 0;\n")
+        fd.write("    }\n")
+    fd.write("    let cycle = self.stamp / 100;\n")
+    fd.write("    let mut budget = budget;\n")
+    fd.write("    // A module stays blocked until its next event becomes valid.\n")
+    for module in sys.modules[:] + sys.downstreams[:]:
+        if not isinstance(module, Module) or is_stub_external(module):
+            continue
+        module_name = namify(module.name)
+        fd.write(f"    if let Some(event) = self.{module_name}_event.front() {{\n")
+        fd.write("      if *event > cycle * 100 {\n")
+        fd.write("        budget = budget.min((*event + 99) / 100 - cycle - 1);\n")
+        fd.write("      }\n")
+        fd.write("    }\n")
+    if not dram_modules:
+        fd.write("    budget\n")
+        fd.write("  }\n\n")
+        return
+    drams = ", ".join(f"&self.mi_{namify(dram.name)}" for dram in dram_modules)
+    fd.write(f"""    if budget == 0 {{
+      return 0;
+    }}
+    let drams = [{drams}];
+    unsafe {{
+      let busy: Vec<usize> = (0..drams.len())
+        .filter(|k| drams[*k].next_event_cycle() != DRAM_NO_EVENT)
+        .collect();
+      if busy.len() > 1 {{
+        return 0;
+      }}
+      let mut skipped = budget as u64;
+      if let Some(k) = busy.first() {{
+        let start = drams[*k].cycle();
+        skipped = drams[*k].skip_to(start + skipped) - start;
+      }}
+      for (k, mi) in drams.iter().enumerate() {{
+        if busy.first() != Some(&k) {{
+          mi.skip_to(mi.cycle() + skipped);
+        }}
+      }}
+      skipped as usize
+    }}
+  }}
+
+""")
+
 
 @enforce_type
 def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-many-statements
@@ -85,6 +207,18 @@ def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-man
             - random: Whether to randomize module execution order
             - resource_base: Path to resource files
             - fifo_depth: Default FIFO depth
+            - fast_forward: Whether to skip idle cycles in one go
+            - dram_threads: Threads ticking the DRAMs, 1 to tick them in turn
+            - core_tck: Pipeline clock period in ns, None to tick DRAMs once per cycle
+            - dram_latency_csv: Directory of the DRAM latency histograms, None for none
+            - dram_samples: Directory of the DRAM time series, None for none
+            - dram_sample_interval: Memory cycles per window of the time series
+            - dram_trace: Directory of the DRAM request traces, None for none
+            - dram_coalesce: Words per line merged into one DRAM transaction, None for none
+            - dram_coalesce_window: Cycles a DRAM write stays open to merging
+            - dram_fast: Whether to simulate DRAMs at fixed latencies instead of with Ramulator2
+            - dram_detailed: (period, window, warmup) in memory cycles of sampled DRAM
+              simulation, None to simulate every cycle in detail
         fd: File descriptor to write to
     """
     # First, analyze the system to determine port requirements and collect DRAM modules
@@ -98,7 +232,6 @@ def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-man
     # Write imports
     fd.write("use sim_runtime::*;\n")
     fd.write("use std::collections::VecDeque;\n")
-    fd.write("use std::collections::HashMap;\n")
     fd.write("use crate::modules;\n")
     # Platform-specific imports are no longer needed since we use the utility method
     fd.write("use std::sync::Arc;\n")
@@ -119,13 +252,13 @@ def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-man
 
     # Begin simulator struct definition
     fd.write("pub struct Simulator { pub stamp: usize, ")
-    fd.write("pub request_stamp_map_table: HashMap<i64, usize>,\n")
-    home = repo_path()
     # Add per-DRAM memory interfaces and response fields
     for dram in dram_modules:
         dram_name = namify(dram.name)
         fd.write(f"pub mi_{dram_name}: MemoryInterface,\n")
         fd.write(f"pub {dram_name}_response: Response,\n")
+        # Issue stamps of the in-flight requests, by request ID
+        fd.write(f"pub {dram_name}_outstanding: Outstanding<usize>,\n")
     # Add array fields to simulator struct
     for array in sys.arrays:
         owner = array.owner
@@ -227,19 +360,21 @@ def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-man
     # Constructor
     fd.write("  pub fn new() -> Self {\n")
     # Initialize per-DRAM memory interfaces
+    constructor = 'new_fast_from_cwrapper_path' if config.get('dram_fast') else 'new_from_cwrapper_path'
     for dram in dram_modules:
         dram_name = namify(dram.name)
         fd.write(f"    let mi_{dram_name} = unsafe {{")
-        fd.write('MemoryInterface::new_from_cwrapper_path()')
+        fd.write(f'MemoryInterface::{constructor}()')
         fd.write(f'.expect("Failed to create MemoryInterface for {dram_name}") }};\n')
         simulator_init.append(f"mi_{dram_name}: mi_{dram_name},")
+        simulator_init.append(f"{dram_name}_outstanding: Outstanding::new(),")
+        # Sized to the word once, so that responses only ever copy into it
         simulator_init.append(  # noqa: E501
             f"{dram_name}_response: Response {{ valid: false, addr: 0, "
-            f"data: Vec::new(), read_succ: false, write_succ: false, "
-            f"is_write: false }},")
+            f"data: Vec::with_capacity({(dram.width + 7) // 8}), read_succ: false, "
+            f"write_succ: false, is_write: false }},")
     fd.write("    Simulator {\n")
     fd.write("      stamp: 0,\n")
-    fd.write("      request_stamp_map_table: HashMap::new(),\n")
     for init in simulator_init:
         fd.write(f"      {init}\n")
     fd.write("    }\n")
@@ -291,6 +426,28 @@ def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-man
         fd.write(f"    self.{dram_name}_response.write_succ = false;\n")
     fd.write("  }\n\n")
 
+    # Drain DRAM completions into the responses, in completion order, read
+    # in place from the wrapper's queue: nothing ticks until they are released
+    fd.write("  pub fn poll_dram(&mut self) {\n")
+    for dram in dram_modules:
+        dram_name = namify(dram.name)
+        fd.write(f"""    loop {{
+      let done = unsafe {{ self.mi_{dram_name}.peek_completions() }};
+      if done.is_empty() {{
+        break;
+      }}
+      for (completion, data) in done.iter() {{
+        crate::modules::{dram_name}::response_of_{dram_name}(self, completion, data);
+      }}
+      unsafe {{ self.mi_{dram_name}.release_completions(done.len()) }};
+    }}
+""")
+    fd.write("  }\n\n")
+
+    fast_forward = config.get('fast_forward', False) and can_fast_forward(sys)
+    if fast_forward:
+        dump_fast_forward(sys, dram_modules, fd)
+
     # Get topological order for downstream modules
     downstreams = topo_downstream_modules(sys)
 
@@ -348,16 +505,59 @@ def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-man
     # Generate simulate function
     fd.write("pub fn simulate() {\n")
     fd.write("  let mut sim = Simulator::new();\n")
-    # Initialize each DRAM with configuration
+    # Initialize each DRAM with configuration, and size its backing store
     for dram in dram_modules:
         dram_name = namify(dram.name)
+        word_bytes = (dram.width + 7) // 8
+        load_init = ""
+        if dram.init_file:
+            init_file_path = os.path.join(config.get('resource_base', '.'), dram.init_file)
+            init_file_path = os.path.normpath(init_file_path).replace('//', '/')
+            load_init = f"""
+            assert!(sim.mi_{dram_name}.load_image("{init_file_path}", 0), "can not load init file");"""
+        if config.get('dram_samples'):
+            # After `config_store`: samples count bytes in words of the store
+            samples_path = os.path.join(config['dram_samples'], f"{dram_name}_samples.csv")
+            interval = config.get('dram_sample_interval', 1000)
+            load_init += f"""
+            assert!(sim.mi_{dram_name}.start_sampling("{os.path.normpath(samples_path)}", {interval}, false), "can not open samples file");"""
+        if config.get('dram_detailed'):
+            # After `config_store` too: the estimated bandwidth counts words
+            period, window, warmup = (int(x) for x in config['dram_detailed'])
+            load_init += f"""
+            assert!(sim.mi_{dram_name}.set_detailed_windows({period}, {window}, {warmup}), "invalid detailed windows");"""
+        setup = ""
+        if config.get('core_tck'):
+            setup += f"""
+            sim.mi_{dram_name}.set_core_clock({float(config['core_tck'])});"""
+        if config.get('dram_latency_csv'):
+            # Written when `sim` drops its memory interfaces, i.e. at the end of the run
+            csv_path = os.path.join(config['dram_latency_csv'], f"{dram_name}_latency.csv")
+            setup += f"""
+            sim.mi_{dram_name}.set_latency_csv("{os.path.normpath(csv_path)}");"""
+        if config.get('dram_trace'):
+            trace_path = os.path.join(config['dram_trace'], f"{dram_name}.trace")
+            setup += f"""
+            assert!(sim.mi_{dram_name}.start_trace("{os.path.normpath(trace_path)}"), "can not open trace file");"""
+        if config.get('dram_coalesce'):
+            window = config.get('dram_coalesce_window', 8)
+            setup += f"""
+            sim.mi_{dram_name}.set_coalescing({int(config['dram_coalesce'])}, {int(window)});"""
         fd.write(f"""
      unsafe {{
-            sim.mi_{dram_name}
-                .init("{home}/tools/c-ramulator2-wrapper/configs/example_config.yaml");
+            sim.mi_{dram_name}.init({dram_config_literal(dram, config)});{setup}
+            sim.mi_{dram_name}.config_store({word_bytes}, {dram.depth});{load_init}
         }}
     """)  # noqa: E501
 
+    # Several DRAMs share nothing, so a group may tick them on parallel
+    # threads. Their requests are polled: no callback runs on those threads.
+    dram_threads = config.get('dram_threads', 1)
+    use_dram_group = len(dram_modules) > 1 and dram_threads != 1
+    if use_dram_group:
+        members = ", ".join(f"&sim.mi_{namify(dram.name)}" for dram in dram_modules)
+        fd.write(f"  let dram_group = unsafe {{ DramGroup::new(&[{members}], {dram_threads}) }};\n")
+
     # Handle randomization if enabled
     if config.get('random', False):
         fd.write("  let mut rng = rand::thread_rng();\n")
@@ -423,7 +623,9 @@ def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-man
 
     fd.write(f"""
       let mut idle_count = 0;
-      for i in 1..={sim_threshold} {{
+      let mut i = 0;
+      while i < {sim_threshold} {{
+        i += 1;
         sim.stamp = i * 100;
         sim.reset_downstream();
 {randomization}
@@ -455,13 +657,40 @@ def dump_simulator( #pylint: disable=too-many-locals, too-many-branches, too-man
             // Tick all DRAM memory interfaces
 """)
 
-    for dram in dram_modules:
-        dram_name = namify(dram.name)
-        fd.write(f"            sim.mi_{dram_name}.frontend_tick();\n")
-        fd.write(f"            sim.mi_{dram_name}.memory_system_tick();\n")
+    if use_dram_group:
+        fd.write("            dram_group.tick(1);\n")
+    else:
+        for dram in dram_modules:
+            dram_name = namify(dram.name)
+            fd.write(f"            sim.mi_{dram_name}.tick();\n")
 
     fd.write("        }\n")
+    fd.write("        sim.poll_dram();\n")
+    if fast_forward:
+        # The idle cycles skipped count towards the idle threshold, so the
+        # simulation terminates exactly where cycle-by-cycle ticking would.
+        fd.write(f"""
+        if !any_module_triggered {{
+          let budget = ({idle_threshold} - idle_count - 1).min({sim_threshold} - i);
+          let skipped = sim.fast_forward(budget);
+          i += skipped;
+          idle_count += skipped;
+          sim.poll_dram();
+        }}
+""")
     fd.write("      }\n")
+    if config.get('dram_detailed'):
+        # Sampled DRAMs only estimate their latency and bandwidth
+        for dram in dram_modules:
+            dram_name = namify(dram.name)
+            fd.write(f"""
+      let stats = unsafe {{ sim.mi_{dram_name}.stats() }};
+      println!(
+        "{dram_name}: {{}} detailed windows, latency {{:.2}} +- {{:.2}} memory cycles, bandwidth {{:.3}} +- {{:.3}} GB/s",
+        stats.detailed_windows, stats.est_latency_avg, stats.est_latency_ci,
+        stats.est_bandwidth, stats.est_bandwidth_ci
+      );
+""")  # noqa: E501
     fd.write("    ")
 
     # Close simulate function
@@ -7,7 +7,7 @@ from .builder import SysBuilder, ir_builder, Singleton, rewrite_assign
 from .ir.expr import Expr, log, concat, finish, wait_until, assume
 from .ir.expr import push_condition, pop_condition, get_pred
 from .ir.expr import send_read_request, send_write_request
-from .ir.expr import has_mem_resp
+from .ir.expr import has_mem_resp, mem_free_slots
 from .ir.module import Module, Port, Downstream, fsm
 from .ir.module.external import (
     ExternalSV,
@@ -18,6 +18,7 @@ from .ir.module.external import (
 )
 from .ir.memory.sram import SRAM
 from .ir.memory.dram import DRAM
+from .ir.memory.dram_config import DRAMConfig
 from .ir.block import Condition, Cycle
 from .ir import module
 from .ir.module import downstream
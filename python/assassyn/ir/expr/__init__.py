@@ -6,7 +6,7 @@ from .arith import *
 from .intrinsic import Intrinsic, PureIntrinsic, finish, wait_until, assume
 from .intrinsic import push_condition, pop_condition, get_pred
 from .intrinsic import send_read_request, send_write_request
-from .intrinsic import has_mem_resp
+from .intrinsic import has_mem_resp, mem_free_slots
 from .call import Bind, AsyncCall, FIFOPush
 from .comm import concat
 from .array import ArrayRead, ArrayWrite
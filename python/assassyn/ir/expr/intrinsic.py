@@ -22,6 +22,7 @@ PURE_INTRIN_INFO = {
     306: ('external_output_read', None),  # (instance, port_name[, index]) - variable args
     904: ('has_mem_resp', 1),
     912: ('get_mem_resp', 1),
+    916: ('mem_free_slots', 1),
 }
 
 class Intrinsic(Expr):
@@ -147,6 +148,12 @@ def get_mem_resp(mem):
     and the msb are the corresponding request address.'''
     return PureIntrinsic(PureIntrinsic.GET_MEM_RESP, mem)
 
+@ir_builder
+def mem_free_slots(mem):
+    '''Get the requests the memory system is expected to accept before it
+    rejects one, as a UInt(32), to hold requests back rather than resend them.'''
+    return PureIntrinsic(PureIntrinsic.MEM_FREE_SLOTS, mem)
+
 class PureIntrinsic(Expr):
     '''The class for accessing FIFO fields, valid, and peek'''
 
@@ -166,6 +173,7 @@ class PureIntrinsic(Expr):
     # Memory response operations
     HAS_MEM_RESP = 904
     GET_MEM_RESP = 912
+    MEM_FREE_SLOTS = 916
 
     OPERATORS = {
         FIFO_VALID: 'valid',
@@ -213,6 +221,9 @@ class PureIntrinsic(Expr):
         if self.opcode == PureIntrinsic.CURRENT_CYCLE:
             return UInt(64)
 
+        if self.opcode == PureIntrinsic.MEM_FREE_SLOTS:
+            return UInt(32)
+
         if self.opcode == PureIntrinsic.EXTERNAL_OUTPUT_READ:
             # args[0] is ExternalIntrinsic instance, args[1] is port name
             # args[2] (optional) is index for RegOut
@@ -228,7 +239,7 @@ class PureIntrinsic(Expr):
             fifo = self.args[0].as_operand()
             return f'{self.as_operand()} = {fifo}.{self.OPERATORS[self.opcode]}()'
         if self.opcode in [PureIntrinsic.HAS_MEM_RESP, PureIntrinsic.GET_MEM_RESP,
-                           PureIntrinsic.CURRENT_CYCLE]:
+                           PureIntrinsic.MEM_FREE_SLOTS, PureIntrinsic.CURRENT_CYCLE]:
             mn, _ = PURE_INTRIN_INFO[self.opcode]
             args = ", ".join(i.as_operand() for i in self.args)
             return f'{self.as_operand()} = pure_intrinsic.{mn}({args})'
@@ -3,6 +3,7 @@
 from __future__ import annotations
 
 from .base import MemoryBase
+from .dram_config import DRAMConfig
 from ..module.downstream import combinational
 from ..block import Condition
 from ..expr.intrinsic import (
@@ -18,15 +19,25 @@ class DRAM(MemoryBase):
     soon as response, using several intrinsics to achieve this.
     '''
 
-    def __init__(self, width: int, depth: int, init_file: str | None):
+    # The Ramulator2 configuration: a DRAMConfig, the path to a YAML file,
+    # or inline YAML text spanning several lines
+    config: DRAMConfig | str
+
+    def __init__(self, width: int, depth: int, init_file: str | None,
+                 config: DRAMConfig | str | None = None):
         """Initialize DRAM module.
         
         Args:
             width: Width of memory in bits
             depth: Depth of memory in words (must be power of 2)
             init_file: Path to initialization file (can be None)
+            config: Ramulator2 configuration, `DRAMConfig()` if None. A str is
+                the path to a YAML file, or the YAML text if it spans several lines
         """
         super().__init__(width, depth, init_file)
+        assert config is None or isinstance(config, (DRAMConfig, str)), \
+            f"Config must be DRAMConfig, string or None, got {type(config)}"
+        self.config = DRAMConfig() if config is None else config
 
     @combinational
     def build(self, we, re, addr, wdata):  # pylint: disable=too-many-arguments
@@ -0,0 +1,107 @@
+"""Ramulator2 configuration of a DRAM module."""
+
+from __future__ import annotations
+
+
+class DRAMConfig:  # pylint: disable=too-many-instance-attributes
+    '''The Ramulator2 configuration simulating one DRAM module.
+
+    The defaults reproduce `tools/c-ramulator2-wrapper/configs/example_config.yaml`:
+    one channel of two DDR4_8Gb_x8 ranks at DDR4_2400R timings, scheduled by
+    FRFCFS with a closed row policy. Any other key of the configuration may be
+    set through `overrides`, keyed by its dotted path, e.g.
+    `{'MemorySystem.Controller.RowPolicy.cap': 8}`.
+    '''
+
+    # pylint: disable=too-many-arguments
+    def __init__(self, standard: str = 'DDR4', org: str = 'DDR4_8Gb_x8',
+                 timing: str = 'DDR4_2400R', channels: int = 1, ranks: int | None = 2,
+                 row_policy: str = 'ClosedRowPolicy', scheduler: str = 'FRFCFS',
+                 refresh: str = 'AllBank', addr_mapper: str = 'RoBaRaCoCh',
+                 overrides: dict | None = None):
+        """Initialize a DRAM configuration.
+
+        Args:
+            standard: DRAM standard, e.g. DDR4, DDR5 or HBM2
+            org: Organization preset of the standard, e.g. DDR5_16Gb_x8
+            timing: Timing preset of the standard, e.g. DDR5_3200AN
+            channels: Number of channels
+            ranks: Number of ranks per channel, None for standards without ranks
+            row_policy: Row policy of the controller, e.g. OpenRowPolicy
+            scheduler: Scheduler of the controller, e.g. FCFS
+            refresh: Refresh manager of the controller, e.g. NoRefresh
+            addr_mapper: Address mapping, e.g. RoBaRaCoCh
+            overrides: Extra keys of the configuration, by dotted path
+        """
+        assert isinstance(channels, int) and channels > 0, \
+            f"Channels must be positive integer, got {channels}"
+        assert ranks is None or (isinstance(ranks, int) and ranks > 0), \
+            f"Ranks must be positive integer or None, got {ranks}"
+        self.standard = standard
+        self.org = org
+        self.timing = timing
+        self.channels = channels
+        self.ranks = ranks
+        self.row_policy = row_policy
+        self.scheduler = scheduler
+        self.refresh = refresh
+        self.addr_mapper = addr_mapper
+        self.overrides = dict(overrides or {})
+
+    def to_dict(self) -> dict:
+        '''The configuration as the nested dict of its YAML document.'''
+        org = {'preset': self.org, 'channel': self.channels}
+        if self.ranks is not None:
+            org['rank'] = self.ranks
+        row_policy = {'impl': self.row_policy}
+        if self.row_policy == 'ClosedRowPolicy':
+            row_policy['cap'] = 4
+        config = {
+            'Frontend': {'impl': 'GEM5', 'clock_ratio': 1},
+            'MemorySystem': {
+                'impl': 'GenericDRAM',
+                'clock_ratio': 1,
+                'DRAM': {
+                    'impl': self.standard,
+                    'org': org,
+                    'timing': {'preset': self.timing},
+                },
+                'Controller': {
+                    'impl': 'Generic',
+                    'Scheduler': {'impl': self.scheduler},
+                    'RefreshManager': {'impl': self.refresh},
+                    'RowPolicy': row_policy,
+                },
+                'AddrMapper': {'impl': self.addr_mapper},
+            },
+        }
+        for path, value in self.overrides.items():
+            node = config
+            *parents, key = path.split('.')
+            for parent in parents:
+                node = node.setdefault(parent, {})
+            node[key] = value
+        return config
+
+    def to_yaml(self) -> str:
+        '''The configuration as YAML text, which `dram_init` accepts in place of a path.'''
+        lines = []
+        _dump_yaml(self.to_dict(), 0, lines)
+        return '\n'.join(lines) + '\n'
+
+    def __repr__(self):
+        return f'DRAMConfig({self.standard}, {self.org}, {self.timing}, ' \
+               f'channels={self.channels}, ranks={self.ranks})'
+
+
+def _dump_yaml(node: dict, indent: int, lines: list):
+    '''Append the block YAML of the nested dict `node` to `lines`.'''
+    for key, value in node.items():
+        prefix = ' ' * indent + f'{key}:'
+        if isinstance(value, dict):
+            lines.append(prefix)
+            _dump_yaml(value, indent + 2, lines)
+        elif isinstance(value, bool):
+            lines.append(f'{prefix} {"true" if value else "false"}')
+        else:
+            lines.append(f'{prefix} {value}')
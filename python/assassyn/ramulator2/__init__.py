@@ -2,4 +2,4 @@
 
 '''Ramulator2 module for the Assassyn compiler.'''
 
-from .ramulator2 import PyRamulator, Request
+from .ramulator2 import PyRamulator, DramCompletion, DramGroup
@@ -6,7 +6,8 @@ library through the CRamualator2Wrapper C++ wrapper.
 import os
 import sys
 import ctypes
-from ctypes import c_void_p, c_char_p, c_float, c_bool, c_int64, CFUNCTYPE
+from ctypes import (c_void_p, c_char_p, c_float, c_bool, c_int64, c_uint32, c_uint64,
+                    c_double, CFUNCTYPE, POINTER, c_uint8)
 
 def get_library_paths():
     """Get the paths to the wrapper and ramulator2 shared libraries.
@@ -63,53 +64,190 @@ wrapper = load_shared_library(wrapper_path)
 ramulator = load_shared_library(ramulator2_path)
 
 
-# --- Define Request struct (partial mirror) --- pylint: disable=too-few-public-methods
-class Request(ctypes.Structure):
-    """Memory request structure mirroring the C++ Request class."""
+class DramCompletion(ctypes.Structure):  # pylint: disable=too-few-public-methods
+    """Mirror of `dram_completion_t`: one completed request, handed to its
+    callback or taken by polling."""
     _fields_ = [
-        ("addr", c_int64),               # Addr_t
-        ("addr_vec_placeholder", ctypes.c_byte * 24),  # std::vector dummy (GCC/libstdc++ x86_64)
-        ("type_id", ctypes.c_int),
-        ("source_id", ctypes.c_int),
-        ("command", ctypes.c_int),
-        ("final_command", ctypes.c_int),
-        ("is_stat_updated", c_bool),
-        ("_padding", ctypes.c_byte * 7),   # align to 8 bytes
-        ("arrive", c_int64),             # Clk_t
-        ("depart", c_int64),             # Clk_t
-        ("scratchpad", ctypes.c_int * 4),
-        ("callback_placeholder", ctypes.c_byte * 32),  # std::function dummy
-        ("m_payload", c_void_p),
+        ("id", c_uint64),
+        ("addr", c_int64),
+        ("cycle", c_uint64),
+        ("latency", c_uint32),
+        ("is_write", c_bool),
+        ("reserved", c_uint8 * 3),
     ]
 
-# Define callback type
-CALLBACK = CFUNCTYPE(None, c_void_p, c_void_p)
+class DramStats(ctypes.Structure):  # pylint: disable=too-few-public-methods
+    """Mirror of `dram_stats_t`: a snapshot of the counters of one memory.
+
+    Latencies are in memory cycles and cover completed requests only;
+    `bandwidth` is in GB/s over the memory cycles so far.
+    """
+    _fields_ = [
+        ("struct_size", c_uint64),
+        ("cycle", c_uint64),
+        ("memory_cycle", c_uint64),
+        ("reads", c_uint64),
+        ("writes", c_uint64),
+        ("rejected", c_uint64),
+        ("reads_completed", c_uint64),
+        ("writes_completed", c_uint64),
+        ("outstanding", c_uint64),
+        ("bytes_read", c_uint64),
+        ("bytes_written", c_uint64),
+        ("latency_sum", c_uint64),
+        ("latency_min", c_uint64),
+        ("latency_max", c_uint64),
+        ("latency_p50", c_uint64),
+        ("latency_p95", c_uint64),
+        ("latency_p99", c_uint64),
+        ("latency_avg", c_double),
+        ("bandwidth", c_double),
+        ("latency_p999", c_uint64),
+        ("read_latency_p50", c_uint64),
+        ("read_latency_p99", c_uint64),
+        ("read_latency_p999", c_uint64),
+        ("read_latency_max", c_uint64),
+        ("write_latency_p50", c_uint64),
+        ("write_latency_p99", c_uint64),
+        ("write_latency_p999", c_uint64),
+        ("write_latency_max", c_uint64),
+        ("coalesced_reads", c_uint64),
+        ("coalesced_writes", c_uint64),
+        ("detailed_windows", c_uint64),
+        ("detailed_memory_cycles", c_uint64),
+        ("est_latency_avg", c_double),
+        ("est_latency_ci", c_double),
+        ("est_bandwidth", c_double),
+        ("est_bandwidth_ci", c_double),
+        ("row_switches", c_uint64),
+        ("prefetches", c_uint64),
+        ("prefetches_dropped", c_uint64),
+        ("prefetches_useful", c_uint64),
+        ("prefetches_late", c_uint64),
+        ("prefetches_useless", c_uint64),
+    ]
+
+    def to_dict(self) -> dict:
+        """Return the counters by name."""
+        return {name: getattr(self, name) for name, _ in self._fields_}
+
+class DramSample(ctypes.Structure):  # pylint: disable=too-few-public-methods
+    """Mirror of `dram_sample_t`: one window of the time series taken by
+    `PyRamulator.start_sampling`, and one record of its binary output."""
+    _fields_ = [
+        ("memory_cycle", c_uint64),
+        ("cycle", c_uint64),
+        ("bytes_read", c_uint64),
+        ("bytes_written", c_uint64),
+        ("reads_completed", c_uint32),
+        ("writes_completed", c_uint32),
+        ("rejected", c_uint32),
+        ("outstanding", c_uint32),
+        ("occupancy_sum", c_uint64),
+        ("latency_sum", c_uint64),
+    ]
+
+    @classmethod
+    def read_binary(cls, path: str) -> list:
+        """Read the samples of a binary output file, in native byte order."""
+        with open(path, 'rb') as f:
+            data = f.read()
+        size = ctypes.sizeof(cls)
+        return [cls.from_buffer_copy(data, i) for i in range(0, len(data) - size + 1, size)]
+
+# Define callback type: the completion record, its word of data and the ctx
+CALLBACK = CFUNCTYPE(None, POINTER(DramCompletion), POINTER(c_uint8), c_void_p)
+# Prefetch hook type: the demand read's address, the addresses out, their
+# maximum and the ctx; returns how many were written
+PREFETCH_HOOK = CFUNCTYPE(c_uint32, c_int64, POINTER(c_int64), c_uint32, c_void_p)
 # CRamualator2Wrapper* opaque type
 CRamualator2WrapperPtr = c_void_p
-# Bind functions
-wrapper.dram_new.argtypes = []
-wrapper.dram_new.restype = CRamualator2WrapperPtr
 
-wrapper.dram_delete.argtypes = [CRamualator2WrapperPtr]
-wrapper.dram_delete.restype = None
 
-wrapper.dram_init.argtypes = [CRamualator2WrapperPtr, c_char_p]
-wrapper.dram_init.restype = None
+class DramVTable(ctypes.Structure):  # pylint: disable=too-few-public-methods
+    """Mirror of `dram_vtable_t` in `CRamualator2Wrapper.h`.
 
-wrapper.get_memory_tCK.argtypes = [CRamualator2WrapperPtr]
-wrapper.get_memory_tCK.restype = c_float
-
-wrapper.send_request.argtypes = [CRamualator2WrapperPtr, c_int64, c_bool, CALLBACK, c_void_p]
-wrapper.send_request.restype = c_bool
+    All the wrapper entry points are resolved once through `dram_get_vtable`.
+    """
+    _fields_ = [
+        ("struct_size", c_uint64),
+        ("dram_new", CFUNCTYPE(CRamualator2WrapperPtr)),
+        ("dram_delete", CFUNCTYPE(None, CRamualator2WrapperPtr)),
+        ("dram_init", CFUNCTYPE(None, CRamualator2WrapperPtr, c_char_p)),
+        ("get_memory_tCK", CFUNCTYPE(c_float, CRamualator2WrapperPtr)),
+        ("send_request", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_int64, c_bool,
+                                   CALLBACK, c_void_p)),
+        ("finish", CFUNCTYPE(None, CRamualator2WrapperPtr)),
+        ("frontend_tick", CFUNCTYPE(None, CRamualator2WrapperPtr)),
+        ("memory_system_tick", CFUNCTYPE(None, CRamualator2WrapperPtr)),
+        ("tick_n", CFUNCTYPE(c_uint64, CRamualator2WrapperPtr, c_uint64, c_bool)),
+        ("run_until", CFUNCTYPE(c_uint64, CRamualator2WrapperPtr, c_uint64, c_bool)),
+        ("get_cycle", CFUNCTYPE(c_uint64, CRamualator2WrapperPtr)),
+        ("next_event_cycle", CFUNCTYPE(c_uint64, CRamualator2WrapperPtr)),
+        ("skip_to", CFUNCTYPE(c_uint64, CRamualator2WrapperPtr, c_uint64)),
+        ("config_store", CFUNCTYPE(None, CRamualator2WrapperPtr, c_uint32, c_uint64)),
+        ("load_hex", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_char_p)),
+        ("send_write", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_int64, POINTER(c_uint8),
+                                 CALLBACK, c_void_p)),
+        ("read_data", CFUNCTYPE(None, CRamualator2WrapperPtr, c_int64, POINTER(c_uint8))),
+        ("load_image", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_char_p, c_uint64)),
+        ("send_requests", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr, POINTER(c_int64),
+                                    POINTER(c_bool), c_uint32, POINTER(c_uint8), CALLBACK,
+                                    c_void_p, POINTER(c_uint64))),
+        ("submit", CFUNCTYPE(c_uint64, CRamualator2WrapperPtr, c_int64, c_bool,
+                             POINTER(c_uint8), CALLBACK, c_void_p)),
+        ("next_request_id", CFUNCTYPE(c_uint64, CRamualator2WrapperPtr)),
+        ("poll_completions", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr,
+                                       POINTER(DramCompletion), POINTER(c_uint8), c_uint32)),
+        ("group_new", CFUNCTYPE(c_void_p, c_uint32)),
+        ("group_delete", CFUNCTYPE(None, c_void_p)),
+        ("group_add", CFUNCTYPE(None, c_void_p, CRamualator2WrapperPtr)),
+        ("group_tick", CFUNCTYPE(None, c_void_p, c_uint64)),
+        ("set_core_clock", CFUNCTYPE(None, CRamualator2WrapperPtr, c_double)),
+        ("get_memory_cycle", CFUNCTYPE(c_uint64, CRamualator2WrapperPtr)),
+        ("get_stats", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr, POINTER(DramStats),
+                                c_uint32)),
+        ("dump_latency_csv", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_char_p)),
+        ("set_latency_csv", CFUNCTYPE(None, CRamualator2WrapperPtr, c_char_p)),
+        ("start_sampling", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_char_p, c_uint64,
+                                     c_bool)),
+        ("stop_sampling", CFUNCTYPE(None, CRamualator2WrapperPtr)),
+        ("start_trace", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_char_p)),
+        ("stop_trace", CFUNCTYPE(c_bool, CRamualator2WrapperPtr)),
+        ("checkpoint", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_char_p)),
+        ("restore", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_char_p)),
+        ("get_word_bytes", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr)),
+        ("set_coalescing", CFUNCTYPE(None, CRamualator2WrapperPtr, c_uint64, c_uint64)),
+        ("dram_new_fast", CFUNCTYPE(CRamualator2WrapperPtr)),
+        ("set_detailed_windows", CFUNCTYPE(c_bool, CRamualator2WrapperPtr, c_uint64, c_uint64,
+                                           c_uint64)),
+        ("dram_init_mapped", CFUNCTYPE(None, CRamualator2WrapperPtr, c_char_p, c_char_p)),
+        ("decode_addr", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr, c_int64, POINTER(c_int64),
+                                  c_uint32)),
+        ("addr_level_name", CFUNCTYPE(c_char_p, CRamualator2WrapperPtr, c_uint32)),
+        ("peek_completions", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr,
+                                       POINTER(POINTER(DramCompletion)),
+                                       POINTER(POINTER(c_uint8)))),
+        ("release_completions", CFUNCTYPE(None, CRamualator2WrapperPtr, c_uint32)),
+        ("queue_free_slots", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr)),
+        ("num_channels", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr)),
+        ("channel_occupancy", CFUNCTYPE(c_uint32, CRamualator2WrapperPtr, c_uint32)),
+        ("dram_reset", CFUNCTYPE(None, CRamualator2WrapperPtr)),
+        ("set_prefetch_hook", CFUNCTYPE(None, CRamualator2WrapperPtr, PREFETCH_HOOK, c_void_p)),
+    ]
 
-wrapper.finish.argtypes = [CRamualator2WrapperPtr]
-wrapper.finish.restype = None
 
-wrapper.frontend_tick.argtypes = [CRamualator2WrapperPtr]
-wrapper.frontend_tick.restype = None
+# Bind the single entry point, and the function table behind it
+wrapper.dram_get_vtable.argtypes = []
+wrapper.dram_get_vtable.restype = ctypes.POINTER(DramVTable)
+vtable = wrapper.dram_get_vtable().contents
+if vtable.struct_size < ctypes.sizeof(DramVTable):
+    raise RuntimeError("libwrapper is older than this binding, please rebuild it")
 
-wrapper.memory_system_tick.argtypes = [CRamualator2WrapperPtr]
-wrapper.memory_system_tick.restype = None
+# Returned by `submit` when the request is rejected
+DRAM_REJECTED = 0
+# Returned by `next_event_cycle` when no request is in flight
+DRAM_NO_EVENT = (1 << 64) - 1
 
 
 class PyRamulator:
@@ -119,27 +257,47 @@ class PyRamulator:
     memory simulator through the CRamualator2Wrapper C++ wrapper.
     """
 
-    def __init__(self, config_path: str):
+    def __init__(self, config_path: str, fast: bool = False, mapper: str = None):
         """Initialize PyRamulator with configuration file.
 
         Args:
-            config_path: Path to the YAML configuration file.
+            config_path: Path to the YAML configuration file, or the YAML
+                text itself if it spans several lines.
+            fast: Simulate a fixed-latency memory instead of Ramulator2's,
+                as set by the `FastMemory` section of the configuration.
+            mapper: Address mapper replacing the `AddrMapper` of the
+                configuration, e.g. `ChRaBaRoCo`, None to keep it.
 
         Raises:
             RuntimeError: If the CRamualator2Wrapper instance cannot be created.
         """
-        self.obj = wrapper.dram_new()
+        self.obj = vtable.dram_new_fast() if fast else vtable.dram_new()
         if not self.obj:
             raise RuntimeError("Failed to create CRamualator2Wrapper instance")
-        wrapper.dram_init(self.obj, config_path.encode('utf-8'))
+        if mapper:
+            vtable.dram_init_mapped(self.obj, config_path.encode('utf-8'), mapper.encode('utf-8'))
+        else:
+            vtable.dram_init(self.obj, config_path.encode('utf-8'))
         self.call_backs = []  # to keep references to callbacks
         self.ctxs = {}  # to keep references to ctx objects
+        self.prefetch_hook = None  # to keep a reference to the hook
+        self.word_bytes = 4  # word size of the backing store
 
     def __del__(self):
         """Clean up the underlying C++ wrapper instance."""
         if self.obj:
-            wrapper.dram_delete(self.obj)
+            vtable.dram_delete(self.obj)
             self.obj = None
+
+    def reset(self):
+        """Return to cycle 0, with nothing in flight and cleared statistics
+        and backing store, without parsing the configuration again. Requests
+        in flight are dropped without completing."""
+        vtable.dram_reset(self.obj)
+        self.call_backs = []
+        self.ctxs = {}
+        self.prefetch_hook = None
+
     # pylint: disable=invalid-name
     def get_memory_tCK(self) -> float:
         """Get memory clock period (tCK) in nanoseconds.
@@ -147,31 +305,221 @@ class PyRamulator:
         Returns:
             Memory clock period in nanoseconds.
         """
-        return wrapper.get_memory_tCK(self.obj)
+        return vtable.get_memory_tCK(self.obj)
 
     def finish(self):
         """Finalize the simulation and collect statistics."""
-        wrapper.finish(self.obj)
+        vtable.finish(self.obj)
 
     def frontend_tick(self):
         """Advance the frontend simulation by one clock cycle."""
-        wrapper.frontend_tick(self.obj)
+        vtable.frontend_tick(self.obj)
 
     def memory_system_tick(self):
         """Advance the memory system simulation by one clock cycle."""
-        wrapper.memory_system_tick(self.obj)
+        vtable.memory_system_tick(self.obj)
 
-    def send_request(self, addr: int, is_write: bool, callback, ctx) -> bool:
-        """Send a memory request to the simulated memory system.
+    def tick_n(self, n: int, stop_on_completion: bool = False) -> int:
+        """Advance the frontend and the memory system together by up to n cycles.
 
         Args:
-            addr: Memory address for the request.
-            is_write: True for write request, False for read request.
-            callback: Python function to call when request completes.
-            ctx: Context object passed to the callback function.
+            n: Maximum number of cycles to advance.
+            stop_on_completion: Return right after the first cycle in which a
+                request completed.
 
         Returns:
-            True if request was successfully enqueued, False otherwise.
+            The number of cycles actually advanced.
+        """
+        return vtable.tick_n(self.obj, n, stop_on_completion)
+
+    def run_until(self, cycle: int, stop_on_completion: bool = False) -> int:
+        """Advance the memory until its cycle counter reaches the given cycle.
+
+        Returns:
+            The number of cycles actually advanced.
+        """
+        return vtable.run_until(self.obj, cycle, stop_on_completion)
+
+    def get_cycle(self) -> int:
+        """Get the number of cycles since initialization: memory system ticks,
+        or core cycles once `set_core_clock` is called."""
+        return vtable.get_cycle(self.obj)
+
+    def set_core_clock(self, core_tck: float):
+        """Clock the memory system at its own period against a core clock.
+
+        Each cycle then ticks the memory system as many times as its cycles
+        fit in a core cycle of `core_tck` ns, possibly none.
+
+        Args:
+            core_tck: Core clock period in ns, 0 for one memory tick per cycle.
+        """
+        vtable.set_core_clock(self.obj, core_tck)
+
+    def get_memory_cycle(self) -> int:
+        """Get the number of memory system ticks since initialization."""
+        return vtable.get_memory_cycle(self.obj)
+
+    def get_stats(self) -> DramStats:
+        """Take a snapshot of the counters, cheap enough to sample mid-run."""
+        stats = DramStats()
+        vtable.get_stats(self.obj, ctypes.byref(stats), ctypes.sizeof(stats))
+        return stats
+
+    def dump_latency_csv(self, path: str) -> bool:
+        """Write the read and write latency histograms to a CSV file.
+
+        Each non-empty bucket is one `type,low,high,count` line, `low` and
+        `high` being the latencies it holds, in memory cycles.
+
+        Returns:
+            False if the file cannot be opened.
+        """
+        return vtable.dump_latency_csv(self.obj, path.encode('utf-8'))
+
+    def set_latency_csv(self, path: str):
+        """Dump the latency histograms to `path` when the memory is deleted.
+
+        An empty path dumps nothing.
+        """
+        vtable.set_latency_csv(self.obj, path.encode('utf-8'))
+
+    def start_sampling(self, path: str, interval: int, binary: bool = False) -> bool:
+        """Record a `DramSample` every `interval` memory cycles.
+
+        A background thread of the wrapper writes the samples to `path`, as
+        CSV or, if `binary` is set, as raw records (see
+        `DramSample.read_binary`). Replaces any sampling in progress.
+
+        Returns:
+            False if the file cannot be opened.
+        """
+        return vtable.start_sampling(self.obj, path.encode('utf-8'), interval, binary)
+
+    def stop_sampling(self):
+        """Record the window in progress and write out every sample.
+
+        Deleting the memory does it too.
+        """
+        vtable.stop_sampling(self.obj)
+
+    def start_trace(self, path: str) -> bool:
+        """Record every accepted request to `path`.
+
+        Records hold the cycle, address, type and ID of each request, in the
+        binary trace format replayed by the wrapper's `dram_replay`, encoded by
+        a background thread of the wrapper. Replaces any recording in progress.
+
+        Returns:
+            False if the file cannot be created.
+        """
+        return vtable.start_trace(self.obj, path.encode('utf-8'))
+
+    def stop_trace(self) -> bool:
+        """Write out every record and close the trace.
+
+        Deleting the memory does it too.
+
+        Returns:
+            False if anything failed to be written.
+        """
+        return vtable.stop_trace(self.obj)
+
+    def checkpoint(self, path: str) -> bool:
+        """Save the state of the memory to `path`.
+
+        Ticks until no request is in flight, so the clock advances, then
+        saves the clocks, the statistics, the backing store and the
+        completions not yet polled.
+        The queues and banks of the memory system are not saved: a restored
+        memory starts them empty and closed. Requests with a callback must be
+        drained before, as callbacks do not outlive the process.
+
+        Returns:
+            False if the file cannot be written.
+        """
+        return vtable.checkpoint(self.obj, path.encode('utf-8'))
+
+    def restore(self, path: str) -> bool:
+        """Restore the state saved by `checkpoint` into this memory.
+
+        The memory must be initialized, with no request in flight. Stops
+        sampling, if running. On failure, the memory is left unchanged.
+
+        Returns:
+            False if the file cannot be read or is not a checkpoint.
+        """
+        if not vtable.restore(self.obj, path.encode('utf-8')):
+            return False
+        self.word_bytes = vtable.get_word_bytes(self.obj)
+        return True
+
+    def next_event_cycle(self) -> int:
+        """Get the earliest cycle at which a completion may arrive.
+
+        Returns:
+            The cycle of the first completion due on a fast memory, or for
+            reads served by the prefetch buffer, the next cycle while
+            Ramulator2 holds a request, or `DRAM_NO_EVENT` when idle.
+        """
+        return vtable.next_event_cycle(self.obj)
+
+    def skip_to(self, cycle: int) -> int:
+        """Fast-forward to the given cycle, stopping right after the first completion.
+
+        Returns:
+            The cycle actually reached.
+        """
+        return vtable.skip_to(self.obj, cycle)
+
+    def config_store(self, word_bytes: int, num_words: int = 0):
+        """Set the word size and the depth of the backing store.
+
+        This drops all the data held by the store.
+
+        Args:
+            word_bytes: Size of a word in bytes.
+            num_words: Depth of the store in words, 0 if unknown.
+        """
+        self.word_bytes = max(word_bytes, 1)
+        vtable.config_store(self.obj, self.word_bytes, num_words)
+
+    def load_hex(self, path: str) -> bool:
+        """Preload the backing store from a hex file, one word per line.
+
+        Returns:
+            False if the file cannot be opened.
+        """
+        return vtable.load_hex(self.obj, path.encode('utf-8'))
+
+    def load_image(self, path: str, base_addr: int = 0) -> bool:
+        """Preload a raw little-endian image, or a hex file, at the given word.
+
+        The file is a raw image if its name ends in `.bin`, and a hex file
+        otherwise. Page-aligned parts of a raw image are mapped from the
+        file, not copied.
+
+        Returns:
+            False if the file cannot be opened, or is loaded as a hex file but
+            is not plain text.
+        """
+        return vtable.load_image(self.obj, path.encode('utf-8'), base_addr)
+
+    def read_data(self, addr: int) -> bytes:
+        """Read the word at the given address from the backing store.
+
+        Returns:
+            The word, least significant byte first.
+        """
+        buf = (c_uint8 * self.word_bytes)()
+        vtable.read_data(self.obj, addr, buf)
+        return bytes(buf)
+
+    def _wrap_request(self, callback, ctx):
+        """Wrap a Python callback and its ctx for the C interface.
+
+        Returns:
+            Tuple of (C callback, ctx pointer), both kept alive by this instance.
 
         Raises:
             ValueError: If callback is None.
@@ -184,15 +532,252 @@ class PyRamulator:
         self.ctxs[ctx_ptr.value] = py_obj
 
         # C callback wrapper
-        def _c_callback(req_ptr, ctx_ptr):
-            req = ctypes.cast(req_ptr, ctypes.POINTER(Request)).contents
+        def _c_callback(done_ptr, _data_ptr, ctx_ptr):
+            # copy the record out: the C side reuses it after the call
+            done = DramCompletion.from_buffer_copy(done_ptr.contents)
             # unwrap Python object
             py_obj = self.ctxs.get(ctx_ptr, None)
             ctx_val = py_obj.value
-            callback(req, ctx_val)
+            callback(done, ctx_val)
 
         c_cb = CALLBACK(_c_callback)
         if c_cb not in self.call_backs:
             self.call_backs.append(c_cb)
+        return c_cb, ctx_ptr
+
+    def send_request(self, addr: int, is_write: bool, callback, ctx) -> bool:
+        """Send a memory request to the simulated memory system.
+
+        Args:
+            addr: Memory address for the request.
+            is_write: True for write request, False for read request.
+            callback: Python function to call when request completes.
+            ctx: Context object passed to the callback function.
+
+        Returns:
+            True if request was successfully enqueued, False otherwise.
+
+        Raises:
+            ValueError: If callback is None.
+        """
+        c_cb, ctx_ptr = self._wrap_request(callback, ctx)
+        return vtable.send_request(self.obj, addr, is_write, c_cb, ctx_ptr)
+
+    def send_write(self, addr: int, data: bytes, callback, ctx) -> bool:
+        """Send a write request carrying one word of data.
+
+        The data is committed to the backing store when the request completes.
+
+        Args:
+            addr: Memory address for the request.
+            data: The word to write, least significant byte first. It is
+                zero-padded or truncated to the word size.
+            callback: Python function to call when request completes.
+            ctx: Context object passed to the callback function.
+
+        Returns:
+            True if request was successfully enqueued, False otherwise.
+
+        Raises:
+            ValueError: If callback is None.
+        """
+        c_cb, ctx_ptr = self._wrap_request(callback, ctx)
+        word = bytes(data[:self.word_bytes]).ljust(self.word_bytes, b'\0')
+        buf = (c_uint8 * self.word_bytes).from_buffer_copy(word)
+        return vtable.send_write(self.obj, addr, buf, c_cb, ctx_ptr)
+
+    def submit(self, addr: int, is_write: bool, callback, ctx, data=None) -> int:
+        """Send a memory request and return its ID.
+
+        IDs increase by one per accepted request. The callback finds the ID of
+        the completed request in `done.id`. Without a callback, the
+        request completes into the queue drained by `poll_completions`.
+
+        Args:
+            addr: Memory address for the request.
+            is_write: True for write request, False for read request.
+            callback: Python function to call when request completes, or None
+                to poll its completion instead.
+            ctx: Context object passed to the callback function.
+            data: Optional word committed to the backing store by a write.
+
+        Returns:
+            The request ID, or `DRAM_REJECTED` if it was not enqueued.
+        """
+        if callback is None:
+            c_cb, ctx_ptr = CALLBACK(), None
+        else:
+            c_cb, ctx_ptr = self._wrap_request(callback, ctx)
+        buf = None
+        if data is not None:
+            word = bytes(data[:self.word_bytes]).ljust(self.word_bytes, b'\0')
+            buf = (c_uint8 * self.word_bytes).from_buffer_copy(word)
+        return vtable.submit(self.obj, addr, is_write, buf, c_cb, ctx_ptr)
+
+    def next_request_id(self) -> int:
+        """Get the ID the next accepted request will be given."""
+        return vtable.next_request_id(self.obj)
+
+    def set_coalescing(self, line_size: int, write_window: int = 0):
+        """Merge requests to the same line into one memory transaction.
+
+        Reads join the read of their line of `line_size` addresses in flight,
+        writes the write of their line sent at most `write_window` cycles
+        before. Merged requests keep their own ID and completion, delivered
+        along with the transaction's.
+
+        Args:
+            line_size: Addresses per line, 0 to turn coalescing off.
+            write_window: Cycles during which a write stays open to merging.
+        """
+        vtable.set_coalescing(self.obj, line_size, write_window)
+
+    def set_prefetch_hook(self, hook):
+        """Prefetch the addresses `hook` returns for each demand read, in
+        place of the policy of the configuration's `Prefetcher` section.
+
+        Prefetched lines are read by the wrapper alone; a demand read finding
+        its line completes from it, and `get_stats` counts the useful, late
+        and useless prefetches.
+
+        Args:
+            hook: Callable taking the address of a demand read and returning
+                the addresses to prefetch, of which only the first few are
+                used, or None to go back to the configured policy.
+        """
+        if hook is None:
+            self.prefetch_hook = None
+            vtable.set_prefetch_hook(self.obj, PREFETCH_HOOK(), None)
+            return
+
+        def c_hook(addr, out, max_count, _ctx):
+            targets = list(hook(addr))[:max_count]
+            for i, target in enumerate(targets):
+                out[i] = target
+            return len(targets)
+
+        self.prefetch_hook = PREFETCH_HOOK(c_hook)
+        vtable.set_prefetch_hook(self.obj, self.prefetch_hook, None)
+
+    def set_detailed_windows(self, period: int, window: int, warmup: int = 0) -> bool:
+        """Simulate only sampled windows of the run in detail.
+
+        Of every `period` memory cycles, the first `warmup + window` go
+        through Ramulator2, the rest through a latency model calibrated on the
+        latencies of the last measured `window`. `get_stats` then estimates
+        the run's latency and bandwidth from the windows, with confidence
+        intervals.
+
+        Args:
+            period: Memory cycles per sample, 0 to turn sampling off.
+            window: Memory cycles measured per sample.
+            warmup: Detailed memory cycles before each measured window.
+
+        Returns:
+            bool: False on a fast instance, with requests in flight, or if the
+            windows do not leave the model a cycle of the period.
+        """
+        return vtable.set_detailed_windows(self.obj, period, window, warmup)
+
+    def decode_addr(self, addr: int) -> dict:
+        """Decode `addr` as the configuration's address mapper does.
+
+        Returns:
+            dict: The index of `addr` at each level of the DRAM organization,
+            by name, channel first, e.g. `{'channel': 0, 'rank': 1, ...}`;
+            empty if the wrapper does not model the standard or mapper.
+        """
+        levels = (c_int64 * 8)()
+        count = vtable.decode_addr(self.obj, addr, levels, 8)
+        names = [vtable.addr_level_name(self.obj, i).decode('utf-8') for i in range(count)]
+        return dict(zip(names, levels[:count]))
+
+    def queue_free_slots(self) -> int:
+        """Requests the memory is expected to take before it rejects one: exact
+        for a fast instance, estimated per channel for Ramulator2."""
+        return vtable.queue_free_slots(self.obj)
+
+    def channel_occupancy(self) -> list:
+        """Transactions in flight in each channel, numbered as the channel
+        level of `decode_addr`."""
+        return [vtable.channel_occupancy(self.obj, c)
+                for c in range(vtable.num_channels(self.obj))]
+
+    def poll_completions(self, max_count: int = 64) -> list:
+        """Take up to `max_count` of the requests submitted without a callback
+        that have completed, oldest first.
+
+        Returns:
+            A list of (DramCompletion, bytes) pairs. The bytes are the word a
+            read returned, as of its completion, and zeros for a write.
+        """
+        out = (DramCompletion * max_count)()
+        data = (c_uint8 * (max_count * self.word_bytes))()
+        n = vtable.poll_completions(self.obj, out, data, max_count)
+        w = self.word_bytes
+        return [(out[i], bytes(data[i * w:(i + 1) * w])) for i in range(n)]
+
+    def send_requests(self, addrs, is_writes, callback, ctx, data=None) -> list:
+        """Send a batch of requests with a single call into the wrapper.
+
+        Every request is tried, so a rejected one does not keep the following
+        ones out. All of them share the callback and the ctx.
+
+        Args:
+            addrs: Memory addresses of the requests.
+            is_writes: One write flag per address.
+            callback: Python function to call when each request completes.
+            ctx: Context object passed to the callback function.
+            data: Optional list of one word (bytes) per request, only used by
+                writes. Without it, writes leave the backing store untouched.
+
+        Returns:
+            One bool per request, True if it was enqueued.
+
+        Raises:
+            ValueError: If callback is None, or the lengths do not match.
+        """
+        n = len(addrs)
+        if len(is_writes) != n or (data is not None and len(data) != n):
+            raise ValueError("Expected one write flag (and data word) per address")
+        c_cb, ctx_ptr = self._wrap_request(callback, ctx)
+        c_addrs = (c_int64 * n)(*addrs)
+        c_writes = (c_bool * n)(*is_writes)
+        c_data = None
+        if data is not None:
+            words = b''.join(bytes(w[:self.word_bytes]).ljust(self.word_bytes, b'\0')
+                             for w in data)
+            c_data = (c_uint8 * len(words)).from_buffer_copy(words)
+        accepted = (c_uint64 * ((n + 63) // 64))()
+        vtable.send_requests(self.obj, c_addrs, c_writes, n, c_data, c_cb, ctx_ptr, accepted)
+        return [bool(accepted[i // 64] >> (i % 64) & 1) for i in range(n)]
+
+
+class DramGroup:
+    """Several PyRamulator instances ticked in parallel by the wrapper's threads.
+
+    Completion callbacks of the members would run on those threads, so only
+    members whose requests are polled (submitted without a callback) should be
+    grouped.
+    """
+
+    def __init__(self, members, threads: int = 0):
+        """Group `members` under `threads` threads, the caller included.
+
+        Args:
+            members: The PyRamulator instances, which must outlive the group.
+            threads: Number of threads, 0 for the hardware concurrency.
+        """
+        self.members = list(members)  # keep the members alive
+        self.obj = vtable.group_new(threads)
+        for member in self.members:
+            vtable.group_add(self.obj, member.obj)
+
+    def __del__(self):
+        if getattr(self, 'obj', None):
+            vtable.group_delete(self.obj)
+            self.obj = None
 
-        return wrapper.send_request(self.obj, addr, is_write, c_cb, ctx_ptr)
+    def tick(self, n: int = 1):
+        """Tick every member `n` times and return once all of them are done."""
+        vtable.group_tick(self.obj, n)
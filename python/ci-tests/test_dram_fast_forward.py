@@ -0,0 +1,58 @@
+"""Test that skipping idle cycles delivers every DRAM response on its cycle."""
+
+from assassyn.frontend import *
+from assassyn import backend
+from assassyn import utils
+from assassyn.ir.expr.intrinsic import has_mem_resp, get_mem_resp
+
+
+class Driver(Module):
+    """Sends two reads back to back, then only waits for their responses."""
+
+    def __init__(self):
+        super().__init__(ports={})
+
+    @module.combinational
+    def build(self, dram):
+        """Build the driver, blocked while neither a read to send nor a response."""
+        cnt = RegArray(UInt(32), 1)
+        re = cnt[0] < UInt(32)(2)
+        # Idle while both reads are in flight, so that the cycles can be skipped
+        wait_until(re | has_mem_resp(dram))
+        with Condition(re):
+            (cnt & self)[0] <= cnt[0] + UInt(32)(1)
+        addr = (cnt[0] * UInt(32)(64))[0:8].bitcast(Int(9))
+        dram.build(Bits(1)(0), re, addr, cnt[0])
+        with Condition(has_mem_resp(dram)):
+            resp = get_mem_resp(dram)
+            log('Read response: {}', resp[0:31])
+
+
+def responses(raw):
+    """The response lines of the simulation output."""
+    return [line for line in raw.splitlines() if 'Read response' in line]
+
+
+def impl(fast_forward):
+    """Simulate the system and return its responses."""
+    sys = SysBuilder(f'dram_fast_forward_{int(fast_forward)}')
+    with sys:
+        dram = DRAM(32, 512, None)
+        driver = Driver()
+        driver.build(dram)
+
+    config = backend.config(sim_threshold=2000, idle_threshold=2000,
+                            fast_forward=fast_forward, verilog=False)
+    simulator_path, _ = backend.elaborate(sys, **config)
+    return responses(utils.run_simulator(simulator_path))
+
+
+def test_dram_fast_forward():
+    """A response arriving while the other read is in flight is neither lost nor late."""
+    ticked = impl(False)
+    assert len(ticked) == 2, ticked
+    assert impl(True) == ticked
+
+
+if __name__ == "__main__":
+    test_dram_fast_forward()
@@ -0,0 +1,52 @@
+"""Tests for the Ramulator2 configuration of DRAM modules."""
+
+from assassyn.builder import SysBuilder
+from assassyn.codegen.simulator.simulator import dram_config_literal
+from assassyn.ir.memory.dram import DRAM
+from assassyn.ir.memory.dram_config import DRAMConfig
+
+
+def test_default_config_matches_example_config():
+    """The defaults reproduce the configuration every DRAM used to share."""
+
+    memory = DRAMConfig().to_dict()['MemorySystem']
+    assert memory['DRAM'] == {
+        'impl': 'DDR4',
+        'org': {'preset': 'DDR4_8Gb_x8', 'channel': 1, 'rank': 2},
+        'timing': {'preset': 'DDR4_2400R'},
+    }
+    assert memory['Controller']['Scheduler'] == {'impl': 'FRFCFS'}
+    assert memory['Controller']['RowPolicy'] == {'impl': 'ClosedRowPolicy', 'cap': 4}
+    assert memory['AddrMapper'] == {'impl': 'RoBaRaCoCh'}
+
+
+def test_config_fields_and_overrides():
+    """Named fields land at their keys, overrides at their dotted path."""
+
+    config = DRAMConfig(standard='HBM2', org='HBM2_8Gb', timing='HBM2_2Gbps',
+                        channels=8, ranks=None, row_policy='OpenRowPolicy',
+                        overrides={'MemorySystem.Controller.RowPolicy.cap': 8,
+                                   'MemorySystem.DRAM.org.pseudochannel': 2})
+    memory = config.to_dict()['MemorySystem']
+    assert memory['DRAM']['org'] == {'preset': 'HBM2_8Gb', 'channel': 8, 'pseudochannel': 2}
+    assert memory['Controller']['RowPolicy'] == {'impl': 'OpenRowPolicy', 'cap': 8}
+
+    text = config.to_yaml()
+    assert '\n' in text
+    assert '    org:\n      preset: HBM2_8Gb\n      channel: 8\n' in text
+
+
+def test_dram_config_codegen_literal():
+    """Each kind of config turns into the Rust literal `init` expects."""
+
+    sys = SysBuilder("dram_config")
+    with sys:
+        default = DRAM(32, 16, None)
+        inline = DRAM(32, 16, None, config='Frontend:\n  impl: "GEM5"#\n')
+        path = DRAM(32, 16, None, config='configs/hbm.yaml')
+
+    assert isinstance(default.config, DRAMConfig)
+    assert dram_config_literal(default, {}) == f'r#"{DRAMConfig().to_yaml()}"#'
+    # The raw string needs more hashes than any quote-hash run in the text
+    assert dram_config_literal(inline, {}) == 'r##"Frontend:\n  impl: "GEM5"#\n"##'
+    assert dram_config_literal(path, {'resource_base': '/data'}) == '"/data/configs/hbm.yaml"'
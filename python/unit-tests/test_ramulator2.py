@@ -4,7 +4,7 @@ sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
 
 from assassyn.utils import repo_path
 
-from assassyn.ramulator2 import PyRamulator, Request
+from assassyn.ramulator2 import PyRamulator, DramCompletion
 
 home = repo_path()
 sim = PyRamulator(f"{home}/tools/c-ramulator2-wrapper/configs/example_config.yaml")
@@ -20,9 +20,9 @@ for i in range(200):
     waddr = plused & 0xFF
     addr = waddr if is_write else raddr
 
-    def callback(req: Request, i=i):  # capture i in closure
+    def callback(done: DramCompletion, i=i):  # capture i in closure
         print(
-            f"Cycle {i + 3 + (req.depart - req.arrive)}: Request completed: {req.addr} the data is: {req.addr - 1}",
+            f"Cycle {i + 3 + done.latency}: Request completed: {done.addr} the data is: {done.addr - 1}",
             flush=True,
         )
 
@@ -16,7 +16,7 @@ import pytest
 sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
 
 from assassyn.utils import repo_path
-from assassyn.ramulator2 import PyRamulator, Request
+from assassyn.ramulator2 import PyRamulator, DramCompletion
 
 
 def run_command(command: str, workdir: str, env: Dict[str, str] | None = None) -> Tuple[int, str, str]:
@@ -117,9 +117,9 @@ def run_python_test() -> str:
         waddr = plused & 0xFF
         addr = waddr if is_write else raddr
 
-        def callback(req: Request, i=i):  # capture i in closure
+        def callback(done: DramCompletion, i=i):  # capture i in closure
             output_lines.append(
-                f"Cycle {i + 3 + (req.depart - req.arrive)}: Request completed: {req.addr} the data is: {req.addr - 1}"
+                f"Cycle {i + 3 + done.latency}: Request completed: {done.addr} the data is: {done.addr - 1}"
             )
 
         ok = sim.send_request(addr, is_write, callback, i)
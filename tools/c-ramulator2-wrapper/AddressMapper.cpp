@@ -0,0 +1,202 @@
+#include "./AddressMapper.h"
+#include <cstring>
+
+namespace {
+
+struct OrgPreset {
+  const char* name;
+  uint64_t counts[6];
+};
+
+// The standards whose organization is modeled, with Ramulator2's level
+// names, internal prefetch and channel width in bits, and org presets.
+struct Standard {
+  const char* name;
+  const char* levels[6];
+  uint32_t prefetch;
+  uint32_t channel_width;
+  std::vector<OrgPreset> presets;
+};
+
+const Standard STANDARDS[] = {
+    {"DDR4",
+     {"channel", "rank", "bankgroup", "bank", "row", "column"},
+     8,
+     64,
+     {{"DDR4_2Gb_x4", {1, 1, 4, 4, 1 << 15, 1 << 10}},
+      {"DDR4_2Gb_x8", {1, 1, 4, 4, 1 << 14, 1 << 10}},
+      {"DDR4_2Gb_x16", {1, 1, 2, 4, 1 << 14, 1 << 10}},
+      {"DDR4_4Gb_x4", {1, 1, 4, 4, 1 << 16, 1 << 10}},
+      {"DDR4_4Gb_x8", {1, 1, 4, 4, 1 << 15, 1 << 10}},
+      {"DDR4_4Gb_x16", {1, 1, 2, 4, 1 << 15, 1 << 10}},
+      {"DDR4_8Gb_x4", {1, 1, 4, 4, 1 << 17, 1 << 10}},
+      {"DDR4_8Gb_x8", {1, 1, 4, 4, 1 << 16, 1 << 10}},
+      {"DDR4_8Gb_x16", {1, 1, 2, 4, 1 << 16, 1 << 10}},
+      {"DDR4_16Gb_x4", {1, 1, 4, 4, 1 << 18, 1 << 10}},
+      {"DDR4_16Gb_x8", {1, 1, 4, 4, 1 << 17, 1 << 10}},
+      {"DDR4_16Gb_x16", {1, 1, 2, 4, 1 << 17, 1 << 10}}}},
+    {"DDR5",
+     {"channel", "rank", "bankgroup", "bank", "row", "column"},
+     16,
+     32,
+     {{"DDR5_8Gb_x4", {1, 1, 8, 2, 1 << 16, 1 << 11}},
+      {"DDR5_8Gb_x8", {1, 1, 8, 2, 1 << 16, 1 << 10}},
+      {"DDR5_8Gb_x16", {1, 1, 4, 2, 1 << 16, 1 << 10}},
+      {"DDR5_16Gb_x4", {1, 1, 8, 4, 1 << 16, 1 << 11}},
+      {"DDR5_16Gb_x8", {1, 1, 8, 4, 1 << 16, 1 << 10}},
+      {"DDR5_16Gb_x16", {1, 1, 4, 4, 1 << 16, 1 << 10}},
+      {"DDR5_32Gb_x4", {1, 1, 8, 4, 1 << 17, 1 << 11}},
+      {"DDR5_32Gb_x8", {1, 1, 8, 4, 1 << 17, 1 << 10}},
+      {"DDR5_32Gb_x16", {1, 1, 4, 4, 1 << 17, 1 << 10}}}},
+};
+
+// A missing key of a const node is invalid, and throws on anything but
+// IsDefined.
+bool is_map(const YAML::Node& node) {
+    return node.IsDefined() && node.IsMap();
+}
+
+// log2 of a power of two, or -1.
+int log2_exact(uint64_t value) {
+    if (value == 0 || (value & (value - 1))) {
+        return -1;
+    }
+    int bits = 0;
+    while (value >>= 1) {
+        bits++;
+    }
+    return bits;
+}
+
+// As Ramulator2's slice_lower_bits: take the low `bits` of `addr` off it.
+int64_t slice_lower_bits(uint64_t& addr, uint32_t bits) {
+    int64_t lower = int64_t(addr & ((uint64_t(1) << bits) - 1));
+    addr >>= bits;
+    return lower;
+}
+
+} // namespace
+
+bool AddressMapper::configure(const YAML::Node& memory_system) {
+    names.clear();
+    bits.clear();
+    if (!is_map(memory_system) || !is_map(memory_system["DRAM"]) || !is_map(memory_system["AddrMapper"])) {
+        return false;
+    }
+    const YAML::Node dram = memory_system["DRAM"];
+    std::string impl = dram["impl"].as<std::string>("");
+    std::string mapper = memory_system["AddrMapper"]["impl"].as<std::string>("");
+    if (mapper == "ChRaBaRoCo") {
+        scheme = Scheme::ChRaBaRoCo;
+    } else if (mapper == "RoBaRaCoCh") {
+        scheme = Scheme::RoBaRaCoCh;
+    } else if (mapper == "MOP4CLXOR") {
+        scheme = Scheme::MOP4CLXOR;
+    } else {
+        return false;
+    }
+    const Standard* standard = nullptr;
+    for (const Standard& candidate : STANDARDS) {
+        if (impl == candidate.name) {
+            standard = &candidate;
+        }
+    }
+    if (!standard) {
+        return false;
+    }
+
+    // The preset, if any, then the counts given explicitly.
+    uint64_t counts[6] = {0, 0, 0, 0, 0, 0};
+    const YAML::Node org = dram["org"];
+    std::string preset = is_map(org) ? org["preset"].as<std::string>("") : "";
+    for (const OrgPreset& candidate : standard->presets) {
+        if (preset == candidate.name) {
+            std::memcpy(counts, candidate.counts, sizeof(counts));
+        }
+    }
+    uint32_t prefetch = standard->prefetch;
+    uint32_t channel_width = standard->channel_width;
+    if (is_map(org)) {
+        for (int level = 0; level < 6; level++) {
+            counts[level] = org[standard->levels[level]].as<uint64_t>(counts[level]);
+        }
+        prefetch = org["prefetch"].as<uint32_t>(prefetch);
+        channel_width = org["channel_width"].as<uint32_t>(channel_width);
+    }
+
+    // Ramulator2 decodes transactions: the column loses the bits the
+    // prefetch covers, and the address those of a transaction's bytes.
+    int prefetch_bits = log2_exact(prefetch);
+    int tx_bits = log2_exact(uint64_t(prefetch) * channel_width / 8);
+    if (prefetch_bits < 0 || tx_bits < 0) {
+        return false;
+    }
+    std::vector<uint32_t> level_bits;
+    for (int level = 0; level < 6; level++) {
+        int width = log2_exact(counts[level]);
+        if (width < 0) {
+            return false;
+        }
+        level_bits.push_back(uint32_t(width));
+    }
+    if (level_bits[5] < uint32_t(prefetch_bits) || (scheme == Scheme::MOP4CLXOR && level_bits[5] < 2u + prefetch_bits)) {
+        return false;
+    }
+    level_bits[5] -= prefetch_bits;
+
+    bits = level_bits;
+    names.assign(standard->levels, standard->levels + 6);
+    tx_offset = uint32_t(tx_bits);
+    row = 4;
+    column = 5;
+    banks = 1;
+    for (uint32_t level = 0; level < row; level++) {
+        banks *= counts[level];
+    }
+    return true;
+}
+
+void AddressMapper::decode(int64_t addr, int64_t* out) const {
+    uint64_t rest = uint64_t(addr) >> tx_offset;
+    switch (scheme) {
+    case Scheme::ChRaBaRoCo:
+        // Column in the low bits, then row, bank, ..., channel.
+        for (uint32_t level = num_levels(); level-- > 0;) {
+            out[level] = slice_lower_bits(rest, bits[level]);
+        }
+        break;
+    case Scheme::RoBaRaCoCh:
+        // Channel in the low bits, then column, rank, ..., row.
+        out[0] = slice_lower_bits(rest, bits[0]);
+        out[column] = slice_lower_bits(rest, bits[column]);
+        for (uint32_t level = 1; level <= row; level++) {
+            out[level] = slice_lower_bits(rest, bits[level]);
+        }
+        break;
+    case Scheme::MOP4CLXOR: {
+        // Runs of 4 columns, then the levels above the row, the rest of the
+        // column and the row, with the bank levels XORed with the low row
+        // bits so that rows conflicting in one bank spread over several.
+        int64_t low_columns = slice_lower_bits(rest, 2);
+        for (uint32_t level = 0; level < row; level++) {
+            out[level] = slice_lower_bits(rest, bits[level]);
+        }
+        out[column] = low_columns | (slice_lower_bits(rest, bits[column] - 2) << 2);
+        out[row] = slice_lower_bits(rest, bits[row]);
+        uint32_t shift = 0;
+        for (uint32_t level = 0; level < row; level++) {
+            out[level] ^= (out[row] >> shift) & ((int64_t(1) << bits[level]) - 1);
+            shift += bits[level];
+        }
+        break;
+    }
+    }
+}
+
+uint64_t AddressMapper::bank_of(const int64_t* decoded) const {
+    uint64_t bank = 0;
+    for (uint32_t level = 0; level < row; level++) {
+        bank = (bank << bits[level]) | uint64_t(decoded[level]);
+    }
+    return bank;
+}
@@ -0,0 +1,51 @@
+#ifndef ADDRESSMAPPER_H
+#define ADDRESSMAPPER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+// A model of Ramulator2's linear address mappers, which Ramulator2 keeps
+// inside its memory system: decodes an address, as sent to the memory, into
+// one index per level of the DRAM organization, channel first, column last,
+// as the mapper `impl` of the config would. The organization is that of the
+// config's `DRAM` section: the `org` preset of the standard, with any level
+// count, `channel_width` or `prefetch` of `org` taking precedence.
+class AddressMapper {
+
+public:
+  static constexpr uint32_t MAX_LEVELS = 8;
+
+  // Set up from the `MemorySystem` section of a wrapper config, which may be
+  // undefined. Returns false, leaving no levels, if its standard, preset or
+  // mapper is not modeled, or a level count is not a power of two.
+  bool configure(const YAML::Node &memory_system);
+  // 0 if not configured.
+  uint32_t num_levels() const { return uint32_t(names.size()); }
+  // Name of `level`, as in Ramulator2's `org`, e.g. "bankgroup".
+  const std::string &level_name(uint32_t level) const { return names[level]; }
+  // Write the index of `addr` at each of the `num_levels` levels to `out`.
+  void decode(int64_t addr, int64_t *out) const;
+  // Index of the bank of a decoded address among all banks of the memory,
+  // i.e. over the levels above the row, and their count.
+  uint64_t bank_of(const int64_t *decoded) const;
+  uint64_t num_banks() const { return banks; }
+  // Number of indices at `level`, e.g. of channels at level 0.
+  uint64_t level_count(uint32_t level) const { return uint64_t(1) << bits[level]; }
+  uint32_t row_level() const { return row; }
+
+private:
+  enum class Scheme { ChRaBaRoCo, RoBaRaCoCh, MOP4CLXOR };
+
+  std::vector<std::string> names;
+  std::vector<uint32_t> bits;
+  Scheme scheme = Scheme::ChRaBaRoCo;
+  // Bytes of a transaction, as a shift: prefetch times channel width.
+  uint32_t tx_offset = 0;
+  uint32_t row = 0;
+  uint32_t column = 0;
+  uint64_t banks = 0;
+};
+
+#endif // ADDRESSMAPPER_H
@@ -0,0 +1,310 @@
+#include "./BackingStore.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+BackingStore::~BackingStore() {
+    release();
+}
+
+void BackingStore::release() {
+    if (mapping) {
+        munmap(mapping, mapped_bytes);
+        mapping = nullptr;
+    }
+    mapped_bytes = 0;
+    pages.clear();
+}
+
+void BackingStore::configure(uint32_t word_bytes, uint64_t num_words) {
+    release();
+    this->word_bytes = word_bytes ? word_bytes : 1;
+    uint64_t bytes = num_words * this->word_bytes;
+    if (bytes) {
+        // Only address space is reserved here: untouched pages cost nothing
+        // and read as zero, as the sparse pages do.
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (ptr != MAP_FAILED) {
+            mapping = static_cast<uint8_t*>(ptr);
+            mapped_bytes = bytes;
+        }
+    }
+}
+
+void BackingStore::swap(BackingStore& other) {
+    std::swap(word_bytes, other.word_bytes);
+    std::swap(mapped_bytes, other.mapped_bytes);
+    std::swap(mapping, other.mapping);
+    pages.swap(other.pages);
+}
+
+void BackingStore::clear() {
+    configure(word_bytes, mapped_bytes / word_bytes);
+}
+
+uint8_t* BackingStore::locate(uint64_t offset, bool allocate) {
+    if (offset < mapped_bytes) {
+        return mapping + offset;
+    }
+    auto it = pages.find(offset >> SPARSE_PAGE_BITS);
+    if (it == pages.end()) {
+        if (!allocate) {
+            return nullptr;
+        }
+        it = pages.emplace(offset >> SPARSE_PAGE_BITS, std::make_unique<uint8_t[]>(SPARSE_PAGE_SIZE)).first;
+    }
+    return it->second.get() + (offset & (SPARSE_PAGE_SIZE - 1));
+}
+
+const uint8_t* BackingStore::locate(uint64_t offset) const {
+    return const_cast<BackingStore*>(this)->locate(offset, false);
+}
+
+void BackingStore::read(uint64_t addr, uint8_t* out) const {
+    uint64_t offset = addr * word_bytes;
+    uint64_t remaining = word_bytes;
+    // A word may straddle two pages, or the end of the mapping.
+    while (remaining) {
+        uint64_t chunk = std::min(remaining, SPARSE_PAGE_SIZE - (offset & (SPARSE_PAGE_SIZE - 1)));
+        if (const uint8_t* src = locate(offset)) {
+            std::memcpy(out, src, chunk);
+        } else {
+            std::memset(out, 0, chunk);
+        }
+        out += chunk;
+        offset += chunk;
+        remaining -= chunk;
+    }
+}
+
+void BackingStore::write(uint64_t addr, const uint8_t* data) {
+    copy_in(addr * word_bytes, data, word_bytes);
+}
+
+namespace {
+
+// A whole file mapped read-only into memory.
+struct MappedFile {
+    int fd = -1;
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+
+    bool open(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            return false;
+        }
+        size = st.st_size;
+        if (size) {
+            void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                return false;
+            }
+            data = static_cast<const uint8_t*>(ptr);
+        }
+        return true;
+    }
+
+    ~MappedFile() {
+        if (data) {
+            munmap(const_cast<uint8_t*>(data), size);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool is_blank(char c) {
+    return c == '_' || std::isspace((unsigned char)c);
+}
+
+// Hex files are plain text: any other byte means a raw image was taken
+// for one.
+bool is_text(const uint8_t* data, uint64_t size) {
+    for (uint64_t i = 0; i < size; i++) {
+        if (!std::isprint(data[i]) && !std::isspace(data[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool is_raw_image(const std::string& path) {
+    static const std::string extension = ".bin";
+    return path.size() >= extension.size() &&
+           path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+} // namespace
+
+void BackingStore::copy_in(uint64_t offset, const uint8_t* data, uint64_t size) {
+    while (size) {
+        uint64_t chunk = std::min(size, SPARSE_PAGE_SIZE - (offset & (SPARSE_PAGE_SIZE - 1)));
+        std::memcpy(locate(offset, true), data, chunk);
+        data += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+}
+
+namespace {
+
+// Pages are saved as (offset, size, bytes), up to an offset of UINT64_MAX.
+bool save_page(std::FILE* file, uint64_t offset, const uint8_t* data, uint64_t size) {
+    if (std::all_of(data, data + size, [](uint8_t byte) { return byte == 0; })) {
+        return true;
+    }
+    return std::fwrite(&offset, sizeof(offset), 1, file) == 1 && std::fwrite(&size, sizeof(size), 1, file) == 1 &&
+           std::fwrite(data, 1, size, file) == size;
+}
+
+} // namespace
+
+bool BackingStore::save(std::FILE* file) const {
+    uint64_t num_words = mapped_bytes / word_bytes;
+    bool ok = std::fwrite(&word_bytes, sizeof(word_bytes), 1, file) == 1 &&
+              std::fwrite(&num_words, sizeof(num_words), 1, file) == 1;
+    // Untouched pages of the mapping read as zero and are skipped.
+    for (uint64_t offset = 0; ok && offset < mapped_bytes; offset += SPARSE_PAGE_SIZE) {
+        ok = save_page(file, offset, mapping + offset, std::min(SPARSE_PAGE_SIZE, mapped_bytes - offset));
+    }
+    for (auto it = pages.begin(); ok && it != pages.end(); ++it) {
+        ok = save_page(file, it->first << SPARSE_PAGE_BITS, it->second.get(), SPARSE_PAGE_SIZE);
+    }
+    uint64_t end = UINT64_MAX;
+    return ok && std::fwrite(&end, sizeof(end), 1, file) == 1;
+}
+
+bool BackingStore::load(std::FILE* file) {
+    uint32_t saved_word_bytes;
+    uint64_t num_words;
+    if (std::fread(&saved_word_bytes, sizeof(saved_word_bytes), 1, file) != 1 ||
+        std::fread(&num_words, sizeof(num_words), 1, file) != 1) {
+        return false;
+    }
+    configure(saved_word_bytes, num_words);
+    std::vector<uint8_t> page(SPARSE_PAGE_SIZE);
+    for (;;) {
+        uint64_t offset, size;
+        if (std::fread(&offset, sizeof(offset), 1, file) != 1) {
+            return false;
+        }
+        if (offset == UINT64_MAX) {
+            return true;
+        }
+        if (std::fread(&size, sizeof(size), 1, file) != 1 || size > SPARSE_PAGE_SIZE ||
+            std::fread(page.data(), 1, size, file) != size) {
+            return false;
+        }
+        copy_in(offset, page.data(), size);
+    }
+}
+
+void BackingStore::parse_hex(const char* text, uint64_t size, uint64_t base_addr) {
+    std::vector<uint8_t> word(word_bytes);
+    uint64_t addr = base_addr;
+    const char* end = text + size;
+    for (const char* line = text; line < end;) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!eol) {
+            eol = end;
+        }
+        const char* stop = line;
+        while (stop < eol && !(stop[0] == '/' && stop + 1 < eol && stop[1] == '/')) {
+            stop++;
+        }
+        const char* first = line;
+        while (first < stop && is_blank(*first)) {
+            first++;
+        }
+        if (first < stop && *first == '@') {
+            uint64_t value = 0;
+            for (const char* c = first + 1; c < stop; c++) {
+                int digit = hex_digit(*c);
+                if (digit >= 0) {
+                    value = value * 16 + digit;
+                }
+            }
+            addr = base_addr + value;
+        } else if (first < stop) {
+            // Digits are most significant first, words are stored
+            // little-endian. Digits beyond the word width are dropped.
+            std::fill(word.begin(), word.end(), 0);
+            uint64_t nibble = 0;
+            for (const char* c = stop; c > first && nibble < 2ull * word_bytes;) {
+                int digit = hex_digit(*--c);
+                if (digit < 0) {
+                    continue;
+                }
+                word[nibble / 2] |= uint8_t(digit << (4 * (nibble % 2)));
+                nibble++;
+            }
+            write(addr, word.data());
+            addr++;
+        }
+        line = eol + 1;
+    }
+}
+
+bool BackingStore::load_hex(const std::string& path, uint64_t base_addr) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    if (!is_text(file.data, file.size)) {
+        std::fprintf(stderr, "%s is not a hex file: raw images must be named *.bin\n", path.c_str());
+        return false;
+    }
+    parse_hex(reinterpret_cast<const char*>(file.data), file.size, base_addr);
+    return true;
+}
+
+bool BackingStore::load_image(const std::string& path, uint64_t base_addr) {
+    if (!is_raw_image(path)) {
+        return load_hex(path, base_addr);
+    }
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    uint64_t offset = base_addr * word_bytes;
+    uint64_t size = file.size;
+    uint64_t page = sysconf(_SC_PAGESIZE);
+    // Whole pages of the image that fall inside the mapping are mapped in
+    // place of its anonymous pages: copy-on-write, so the file is never
+    // modified, and nothing is read until it is touched.
+    uint64_t whole = size / page * page;
+    if (whole && offset % page == 0 && offset + whole <= mapped_bytes) {
+        void* ptr = mmap(mapping + offset, whole, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED, file.fd, 0);
+        if (ptr != MAP_FAILED) {
+            offset += whole;
+            size -= whole;
+        }
+    }
+    // Whatever is left, a partial last page or an image outside of the
+    // mapping, is copied. Pages of the file are read once, through the
+    // page cache.
+    copy_in(offset, file.data + (file.size - size), size);
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef BACKINGSTORE_H
+#define BACKINGSTORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// The data held by a simulated DRAM, addressed in words of `word_bytes`.
+//
+// Memory is only committed on first write: unwritten words read as zero.
+// When the depth is known, the words live in one anonymous mapping reserved
+// up front, so that the OS allocates its pages lazily. Words outside of that
+// range, or all of them when the depth is unknown, live in pages allocated
+// on first write.
+class BackingStore {
+
+public:
+  BackingStore() = default;
+  ~BackingStore();
+  BackingStore(const BackingStore &) = delete;
+  BackingStore &operator=(const BackingStore &) = delete;
+
+  // Drop all the data and resize words. `num_words` may be 0 if unknown.
+  void configure(uint32_t word_bytes, uint64_t num_words);
+  // Drop all the data, keeping the word size and depth.
+  void clear();
+  uint32_t get_word_bytes() const { return word_bytes; }
+
+  // Copy the `word_bytes` bytes of word `addr` out of, or into, the store.
+  void read(uint64_t addr, uint8_t *out) const;
+  void write(uint64_t addr, const uint8_t *data);
+
+  // Preload words from a hex file in the format of the runtime's
+  // `load_hex_file`: one word per line, `@<hex>` moves to a word address
+  // relative to `base_addr`, `//` starts a comment and `_` is ignored.
+  // Returns false if the file cannot be opened, or is not plain text.
+  bool load_hex(const std::string &path, uint64_t base_addr = 0);
+  // Preload a raw little-endian image at word `base_addr` if `path` ends in
+  // `.bin`, or else a hex file, as `load_hex`. Page-aligned parts of the
+  // image inside the mapping are mapped from the file instead of copied.
+  bool load_image(const std::string &path, uint64_t base_addr);
+
+  // Write the word size, the depth and every page holding data to `file`,
+  // or read them back, replacing the data. Both return false on an I/O
+  // error, or a malformed file.
+  bool save(std::FILE *file) const;
+  bool load(std::FILE *file);
+  // Exchange the data, word size and depth with `other`, so that a store
+  // can be loaded aside and only take effect once it loaded in full.
+  void swap(BackingStore &other);
+
+private:
+  static constexpr unsigned SPARSE_PAGE_BITS = 12;
+  static constexpr uint64_t SPARSE_PAGE_SIZE = uint64_t(1) << SPARSE_PAGE_BITS;
+
+  // Address of byte `offset`, or nullptr if it is not backed yet and
+  // `allocate` is not set.
+  uint8_t *locate(uint64_t offset, bool allocate);
+  const uint8_t *locate(uint64_t offset) const;
+  void copy_in(uint64_t offset, const uint8_t *data, uint64_t size);
+  void parse_hex(const char *text, uint64_t size, uint64_t base_addr);
+  void release();
+
+  uint32_t word_bytes = 4;
+  // Bytes covered by `mapping`, 0 if there is none.
+  uint64_t mapped_bytes = 0;
+  uint8_t *mapping = nullptr;
+  std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> pages;
+};
+
+#endif // BACKINGSTORE_H
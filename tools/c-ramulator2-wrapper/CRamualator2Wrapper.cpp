@@ -1,48 +1,1112 @@
 #include "./CRamualator2Wrapper.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
 
 
-void CRamualator2Wrapper::init(const std::string& config_path){
-    YAML::Node config = Ramulator::Config::parse_config_file(config_path, {});
-    ramulator2_frontend = Ramulator::Factory::create_frontend(config);
-    ramulator2_memorysystem = Ramulator::Factory::create_memory_system(config);
+void CRamualator2Wrapper::init(const std::string& config_text, const std::string& mapper_impl){
+    config = ConfigCache::load(config_text);
+    if (!mapper_impl.empty()) {
+        config["MemorySystem"]["AddrMapper"]["impl"] = mapper_impl;
+    }
+    YAML::Node channel_config = config["Channels"];
+    uint32_t count = channel_config.IsMap() ? channel_config["count"].as<uint32_t>(1) : 1;
+    if (fast || count < 2) {
+        connect(config);
+    } else {
+        // Every channel a memory of the config. They share no state, so a
+        // group ticks them, and only the completions need ordering.
+        interleave = std::max<uint64_t>(1, channel_config["interleave"].as<uint64_t>(64));
+        channels = std::vector<Channel>(count);
+        channel_group = std::make_unique<DramGroup>(channel_config["threads"].as<uint32_t>(1));
+        for (Channel& channel : channels) {
+            channel.memory = std::make_unique<CRamualator2Wrapper>();
+            channel.memory->config = config;
+            channel.memory->connect(config);
+            channel_group->add(channel.memory.get());
+        }
+    }
+    // Both backends: the mapping is a property of the config, not of the
+    // memory simulating it.
+    uint32_t dispatched = std::max<uint32_t>(1, channels.size());
+    if (mapper.configure(config["MemorySystem"])) {
+        bank_rows.assign(mapper.num_banks() * dispatched, -1);
+    }
+    queues.configure(dispatched * (mapper.num_levels() ? uint32_t(mapper.level_count(0)) : 1),
+                     ChannelQueues::DEFAULT_CAPACITY);
+    prefetcher.configure(config["Prefetcher"]);
+
+    slots.reserve(INITIAL_SLOTS);
+    write_data.reserve(INITIAL_SLOTS * store.get_word_bytes());
+    callback_word.assign(store.get_word_bytes(), 0);
+    grow_completions();
+}
+
+void CRamualator2Wrapper::connect(YAML::Node& config) {
+    if (fast) {
+        fast_memory = std::make_unique<FastMemory>(config["FastMemory"]);
+    } else {
+        ramulator2_frontend = Ramulator::Factory::create_frontend(config);
+        ramulator2_memorysystem = Ramulator::Factory::create_memory_system(config);
+
+        ramulator2_frontend->connect_memory_system(ramulator2_memorysystem);
+        ramulator2_memorysystem->connect_frontend(ramulator2_frontend);
+    }
+}
+
+void CRamualator2Wrapper::disconnect() {
+    if(ramulator2_frontend) {
+        delete ramulator2_frontend;
+        ramulator2_frontend = nullptr;
+    }
+    if(ramulator2_memorysystem) {
+        delete ramulator2_memorysystem;
+        ramulator2_memorysystem = nullptr;
+    }
+}
+
+void CRamualator2Wrapper::reset() {
+    end_run();
+    latency_csv.clear();
+    // Ramulator2 has no reset: its frontend and memory system are built
+    // again, from the config `init` parsed, and drop what they held.
+    disconnect();
+    if (channels.empty()) {
+        connect(config);
+    }
+    for (Channel& channel : channels) {
+        channel.memory->reset();
+        channel.done.clear();
+    }
+    delivering = false;
 
-    ramulator2_frontend->connect_memory_system(ramulator2_memorysystem);
-    ramulator2_memorysystem->connect_frontend(ramulator2_frontend);
+    // The pools keep their capacity, with every slot free.
+    for (uint32_t i = 0; i < slots.size(); i++) {
+        slots[i].next_free = i + 1 < slots.size() ? i + 1 : NO_SLOT;
+    }
+    free_slot = slots.empty() ? NO_SLOT : 0;
+    completion_head = completion_tail = 0;
+    hits_head = hits_tail = 0;
+    prefetches_in_flight = 0;
+
+    store.clear();
+    stats = DramStats();
+    std::fill(bank_rows.begin(), bank_rows.end(), -1);
+    queues.configure(queues.num_channels(), ChannelQueues::DEFAULT_CAPACITY);
+    set_coalescing(0, 0);
+    set_prefetch_hook(nullptr, nullptr);
+    prefetcher.clear();
+    windows.reset();
+    model.reset();
+    ramulator_outstanding = 0;
+    next_id = 1;
+    cycle = 0;
+    memory_cycle = 0;
+    core_period = 0;
+    memory_period = 0;
+    clock_phase = 0;
+    num_completed = 0;
+    num_outstanding = 0;
 }
 
 float CRamualator2Wrapper::get_memory_tCK() const {
-    return ramulator2_memorysystem->get_tCK();
+    if (!channels.empty()) {
+        return channels[0].memory->get_memory_tCK();
+    }
+    return fast_memory ? fast_memory->get_tCK() : ramulator2_memorysystem->get_tCK();
+}
+
+bool CRamualator2Wrapper::enqueue(int64_t addr, bool is_write, bool detailed,
+                                  std::function<void(Ramulator::Request&)> callback) {
+    if (fast_memory) {
+        return fast_memory->send(addr, is_write, std::move(callback));
+    }
+    if (!detailed) {
+        return model->send(addr, is_write, std::move(callback));
+    }
+    if (!channels.empty()) {
+        Ramulator::IFrontEnd* frontend = channels[channel_of(addr)].memory->ramulator2_frontend;
+        return frontend->receive_external_requests(is_write, channel_addr(addr), 0, std::move(callback));
+    }
+    return ramulator2_frontend->receive_external_requests(is_write, addr, 0, std::move(callback));
 }
 
 
 bool CRamualator2Wrapper::send_request(int64_t addr, bool is_write, std::function<void(Ramulator::Request&)> callback) {
     bool enqueue_success;
-    enqueue_success = ramulator2_frontend->receive_external_requests(is_write, addr, 0, callback);
+    bool detailed = detailed_now();
+    int64_t decoded[AddressMapper::MAX_LEVELS];
+    uint32_t channel = locate(addr, decoded);
+    enqueue_success = enqueue(addr, is_write, detailed,
+        [this, addr, is_write, detailed, channel, callback](Ramulator::Request& req) {
+            if (defer(addr, req)) {
+                return;
+            }
+            queues.on_complete(channel);
+            num_completed++;
+            num_outstanding--;
+            stats.on_complete(is_write, req.depart - req.arrive);
+            if (windows && detailed) {
+                on_detailed_complete(is_write, uint32_t(req.depart - req.arrive));
+            }
+            callback(req);
+        });
+    stats.on_submit(is_write, enqueue_success);
+    // Only Ramulator2's capacity is estimated.
+    bool learn = !fast_memory && detailed;
+    if (!enqueue_success && learn) {
+        queues.on_reject(channel);
+    }
+    if (enqueue_success) {
+        num_outstanding++;
+        queues.on_accept(channel, learn);
+        track_row(decoded, channel);
+        if (windows && detailed) {
+            ramulator_outstanding++;
+        }
+        if (recorder) {
+            // No ID: this overload does not number requests.
+            recorder->record(TraceRecord{cycle, addr, is_write, 0});
+        }
+    }
     return enqueue_success;
 }
 
+bool CRamualator2Wrapper::send_request(int64_t addr, bool is_write, dram_callback_t callback, void* ctx) {
+    return submit(addr, is_write, nullptr, callback, ctx) != DRAM_REJECTED;
+}
+
+bool CRamualator2Wrapper::send_write(int64_t addr, const uint8_t* data, dram_callback_t callback, void* ctx) {
+    return submit(addr, true, data, callback, ctx) != DRAM_REJECTED;
+}
+
+uint32_t CRamualator2Wrapper::send_requests(const int64_t* addrs, const bool* is_write, uint32_t n,
+                                            const uint8_t* data, dram_callback_t callback, void* ctx,
+                                            uint64_t* accepted) {
+    uint32_t word_bytes = store.get_word_bytes();
+    uint32_t num_accepted = 0;
+    std::fill(accepted, accepted + (n + 63) / 64, 0);
+    // A rejection only means that this request's queue is full: requests
+    // further down may still map to other channels and be accepted.
+    for (uint32_t i = 0; i < n; i++) {
+        const uint8_t* word = data && is_write[i] ? data + size_t(i) * word_bytes : nullptr;
+        if (submit(addrs[i], is_write[i], word, callback, ctx) != DRAM_REJECTED) {
+            accepted[i / 64] |= uint64_t(1) << (i % 64);
+            num_accepted++;
+        }
+    }
+    return num_accepted;
+}
+
+uint64_t CRamualator2Wrapper::submit(int64_t addr, bool is_write, const uint8_t* data, dram_callback_t callback, void* ctx) {
+    uint64_t id = DRAM_REJECTED;
+    if (!is_write && prefetcher.enabled()) {
+        id = take_prefetched(addr, callback, ctx);
+    }
+    if (id == DRAM_REJECTED && line_size) {
+        id = coalesce(addr, is_write, data, callback, ctx);
+    }
+    if (id == DRAM_REJECTED) {
+        id = send(addr, is_write, data, callback, ctx);
+    }
+    if (id != DRAM_REJECTED && prefetcher.enabled()) {
+        // Prefetches go after the demand read that triggers them.
+        if (!is_write) {
+            prefetch(addr);
+        } else if (prefetcher.invalidate(prefetcher.line_of(addr))) {
+            stats.on_prefetch_useless();
+        }
+    }
+    return id;
+}
+
+uint64_t CRamualator2Wrapper::send(int64_t addr, bool is_write, const uint8_t* data, dram_callback_t callback, void* ctx) {
+    uint32_t index = fill_slot(addr, is_write, data, callback, ctx);
+    if (!transact(index)) {
+        stats.on_submit(is_write, false);
+        release_slot(index);
+        return DRAM_REJECTED;
+    }
+    if (line_size) {
+        // The line's newest transaction, which later requests may join.
+        open_line(addr) = OpenLine{uint64_t(addr) / line_size, cycle, memory_cycle, index, is_write};
+    }
+    return accept(addr, is_write);
+}
+
+uint32_t CRamualator2Wrapper::fill_slot(int64_t addr, bool is_write, const uint8_t* data,
+                                        dram_callback_t callback, void* ctx) {
+    uint32_t index = acquire_slot();
+    RequestSlot& slot = slots[index];
+    slot.callback = callback;
+    slot.ctx = ctx;
+    slot.addr = addr;
+    slot.id = next_id;
+    slot.is_write = is_write;
+    slot.commit = data != nullptr;
+    slot.next_merged = NO_SLOT;
+    slot.prefetch = false;
+    if (data) {
+        uint32_t word_bytes = store.get_word_bytes();
+        std::memcpy(&write_data[size_t(index) * word_bytes], data, word_bytes);
+    }
+    return index;
+}
+
+bool CRamualator2Wrapper::transact(uint32_t index) {
+    int64_t addr = slots[index].addr;
+    bool is_write = slots[index].is_write;
+    bool detailed = detailed_now();
+    int64_t decoded[AddressMapper::MAX_LEVELS];
+    uint32_t channel = locate(addr, decoded);
+    bool enqueue_success = enqueue(addr, is_write, detailed,
+        [this, index](Ramulator::Request& req) {
+            // The slot is not written while the channels tick.
+            if (!defer(slots[index].addr, req)) {
+                complete(index, req);
+            }
+        });
+    bool learn = !fast_memory && detailed;
+    if (!enqueue_success) {
+        if (learn) {
+            queues.on_reject(channel);
+        }
+        return false;
+    }
+    queues.on_accept(channel, learn);
+    track_row(decoded, channel);
+    if (windows && detailed) {
+        ramulator_outstanding++;
+    }
+    slots[index].detailed = detailed;
+    slots[index].channel = channel;
+    slots[index].next_merged = NO_SLOT;
+    slots[index].last_merged = index;
+    return true;
+}
+
+void CRamualator2Wrapper::join(uint32_t first, uint32_t index, uint32_t delay) {
+    slots[index].merge_delay = delay;
+    slots[slots[first].last_merged].next_merged = index;
+    slots[first].last_merged = index;
+}
+
+uint64_t CRamualator2Wrapper::accept(int64_t addr, bool is_write) {
+    stats.on_submit(is_write, true);
+    num_outstanding++;
+    if (recorder) {
+        recorder->record(TraceRecord{cycle, addr, is_write, next_id});
+    }
+    return next_id++;
+}
+
+uint64_t CRamualator2Wrapper::coalesce(int64_t addr, bool is_write, const uint8_t* data, dram_callback_t callback, void* ctx) {
+    OpenLine& open = open_line(addr);
+    if (open.slot == NO_SLOT || open.line != uint64_t(addr) / line_size || open.is_write != is_write ||
+        (is_write && cycle - open.cycle > write_window)) {
+        return DRAM_REJECTED;
+    }
+    uint32_t first = open.slot;
+    uint32_t delay = uint32_t(memory_cycle - open.memory_cycle);
+    join(first, fill_slot(addr, is_write, data, callback, ctx), delay);
+    // Accepted like any other request, without reaching the frontend.
+    stats.on_coalesce(is_write);
+    return accept(addr, is_write);
+}
+
+uint64_t CRamualator2Wrapper::take_prefetched(int64_t addr, dram_callback_t callback, void* ctx) {
+    Prefetcher::Line* buffered = prefetcher.find(prefetcher.line_of(addr));
+    if (!buffered) {
+        return DRAM_REJECTED;
+    }
+    bool late = buffered->slot != Prefetcher::ARRIVED;
+    if (!buffered->used) {
+        // Only the first demand read of a line tells whether it came in time.
+        buffered->used = true;
+        stats.on_prefetch_hit(late);
+    }
+    uint32_t index = fill_slot(addr, false, nullptr, callback, ctx);
+    if (late) {
+        // Completes with the prefetch, as a request merged into it.
+        join(buffered->slot, index, uint32_t(memory_cycle - buffered->memory_cycle));
+        return accept(addr, false);
+    }
+    if (hits_tail - hits_head == prefetch_hits.size()) {
+        // Grown as the completion ring is, keeping the order.
+        std::vector<PrefetchHit> grown(std::max<size_t>(INITIAL_COMPLETIONS, prefetch_hits.size() * 2));
+        for (uint64_t i = hits_head; i < hits_tail; i++) {
+            grown[i - hits_head] = prefetch_hits[i & (prefetch_hits.size() - 1)];
+        }
+        prefetch_hits.swap(grown);
+        hits_tail -= hits_head;
+        hits_head = 0;
+    }
+    prefetch_hits[hits_tail++ & (prefetch_hits.size() - 1)] =
+        PrefetchHit{memory_cycle + prefetcher.get_hit_latency(), index};
+    return accept(addr, false);
+}
+
+void CRamualator2Wrapper::prefetch(int64_t addr) {
+    int64_t targets[Prefetcher::MAX_DEGREE];
+    uint32_t count = prefetcher.train(addr, targets);
+    uint64_t demanded = prefetcher.line_of(addr);
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t line = prefetcher.line_of(targets[i]);
+        if (targets[i] < 0 || line == demanded || prefetcher.find(line)) {
+            continue;
+        }
+        if (queue_free_slots() == 0) {
+            // Not even offered: a refusal costs as much as a transaction.
+            stats.on_prefetch_drop();
+            continue;
+        }
+        uint32_t index = acquire_slot();
+        RequestSlot& slot = slots[index];
+        slot.callback = nullptr;
+        slot.ctx = nullptr;
+        slot.addr = prefetcher.line_addr(line);
+        slot.id = 0;
+        slot.is_write = false;
+        slot.commit = false;
+        slot.prefetch = true;
+        if (!transact(index)) {
+            // Speculative: dropped rather than retried. Channels fill up
+            // independently, so the next one may still be taken.
+            release_slot(index);
+            stats.on_prefetch_drop();
+            continue;
+        }
+        prefetches_in_flight++;
+        stats.on_prefetch();
+        if (prefetcher.insert(line, index, memory_cycle)) {
+            stats.on_prefetch_useless();
+        }
+    }
+}
+
+void CRamualator2Wrapper::deliver_prefetch_hits() {
+    // Only those queued before this tick: callbacks may queue more, due
+    // later.
+    for (uint64_t n = hits_tail - hits_head; n; n--) {
+        const PrefetchHit& hit = prefetch_hits[hits_head & (prefetch_hits.size() - 1)];
+        if (hit.due > memory_cycle + 1) {
+            break;
+        }
+        uint32_t index = hit.slot;
+        hits_head++;
+        deliver(index, prefetcher.get_hit_latency());
+    }
+}
+
+void CRamualator2Wrapper::set_prefetch_hook(dram_prefetch_hook_t hook, void* ctx) {
+    prefetcher.set_hook(hook, ctx);
+}
+
+uint64_t CRamualator2Wrapper::next_request_id() const {
+    return next_id;
+}
+
+void CRamualator2Wrapper::set_coalescing(uint64_t line_size, uint64_t write_window) {
+    this->line_size = line_size;
+    this->write_window = write_window;
+    // Transactions in flight stay unmergeable, but their merged requests
+    // still complete with them.
+    open_lines.assign(line_size ? size_t(1) << OPEN_LINE_BITS : 0, OpenLine{0, 0, 0, NO_SLOT, false});
+}
+
+bool CRamualator2Wrapper::set_detailed_windows(uint64_t period, uint64_t window, uint64_t warmup) {
+    if (fast_memory || num_outstanding || prefetches_in_flight || (period && (!window || warmup + window >= period))) {
+        return false;
+    }
+    if (!period) {
+        windows.reset();
+        model.reset();
+        return true;
+    }
+    windows = std::make_unique<DetailedWindows>(period, window, warmup, store.get_word_bytes(),
+                                                double(get_memory_tCK()));
+    // No limits of its own: Ramulator2's queues only bound the detailed
+    // windows. Its latencies are those of the first window on.
+    model = std::make_unique<FastMemory>(YAML::Node());
+    ramulator_outstanding = 0;
+    return true;
+}
+
+void CRamualator2Wrapper::on_detailed_complete(bool is_write, uint32_t latency) {
+    ramulator_outstanding--;
+    windows->on_complete(is_write, latency);
+}
+
+void CRamualator2Wrapper::sampled_tick() {
+    if (!model) {
+        return;
+    }
+    model->tick();
+    if (windows->tick(ramulator_outstanding)) {
+        // As many in flight as Ramulator2 held at most: with its latencies,
+        // that bounds the model's throughput near the window's.
+        model->calibrate(windows->latencies(false), windows->latencies(true),
+                         std::max<uint64_t>(1, windows->peak_in_flight()));
+    }
+}
+
+bool CRamualator2Wrapper::defer(int64_t addr, Ramulator::Request& req) {
+    if (channels.empty() || delivering) {
+        return false;
+    }
+    // Copies the callback too, which fits in its small buffer for C
+    // requests; `done` keeps its capacity, so this does not allocate.
+    channels[channel_of(addr)].done.push_back(req);
+    return true;
+}
+
+void CRamualator2Wrapper::deliver_channels() {
+    delivering = true;
+    for (Channel& channel : channels) {
+        for (Ramulator::Request& req : channel.done) {
+            req.callback(req);
+        }
+        channel.done.clear();
+    }
+    delivering = false;
+}
+
+void CRamualator2Wrapper::ramulator_tick() {
+    if (channels.empty()) {
+        ramulator2_frontend->tick();
+        ramulator2_memorysystem->tick();
+        return;
+    }
+    // Channels take no requests while they tick: callbacks, which may send
+    // some, run after the barrier.
+    channel_group->tick(1);
+    deliver_channels();
+}
+
+uint32_t CRamualator2Wrapper::decode_addr(int64_t addr, int64_t* out, uint32_t max) const {
+    uint32_t levels = mapper.num_levels();
+    if (levels) {
+        int64_t decoded[AddressMapper::MAX_LEVELS];
+        if (channels.empty()) {
+            mapper.decode(addr, decoded);
+        } else {
+            mapper.decode(channel_addr(addr), decoded);
+            decoded[0] = decoded[0] * int64_t(channels.size()) + channel_of(addr);
+        }
+        std::copy(decoded, decoded + std::min(levels, max), out);
+    }
+    return levels;
+}
+
+const char* CRamualator2Wrapper::addr_level_name(uint32_t level) const {
+    return level < mapper.num_levels() ? mapper.level_name(level).c_str() : nullptr;
+}
+
+uint32_t CRamualator2Wrapper::queue_free_slots() const {
+    if (fast_memory) {
+        return uint32_t(std::min<uint64_t>(UINT32_MAX, fast_memory->free_slots()));
+    }
+    if (!detailed_now()) {
+        return uint32_t(std::min<uint64_t>(UINT32_MAX, model->free_slots()));
+    }
+    return queues.free_slots();
+}
+
+uint32_t CRamualator2Wrapper::num_channels() const {
+    return queues.num_channels();
+}
+
+uint32_t CRamualator2Wrapper::channel_occupancy(uint32_t channel) const {
+    return channel < queues.num_channels() ? queues.occupancy(channel) : 0;
+}
+
+uint32_t CRamualator2Wrapper::locate(int64_t addr, int64_t* decoded) const {
+    uint32_t channel = 0;
+    int64_t local = addr;
+    if (!channels.empty()) {
+        channel = channel_of(addr);
+        local = channel_addr(addr);
+    }
+    if (!mapper.num_levels()) {
+        return channel;
+    }
+    mapper.decode(local, decoded);
+    // As `decode_addr` numbers them: the dispatch channel varies fastest.
+    return uint32_t(decoded[0]) * std::max<uint32_t>(1, channels.size()) + channel;
+}
+
+void CRamualator2Wrapper::track_row(const int64_t* decoded, uint32_t channel) {
+    if (bank_rows.empty()) {
+        return;
+    }
+    uint32_t dispatched = std::max<uint32_t>(1, channels.size());
+    int64_t& last = bank_rows[mapper.bank_of(decoded) * dispatched + channel % dispatched];
+    int64_t row = decoded[mapper.row_level()];
+    if (last != -1 && last != row) {
+        stats.on_row_switch();
+    }
+    last = row;
+}
+
+void CRamualator2Wrapper::config_store(uint32_t word_bytes, uint64_t num_words) {
+    store.configure(word_bytes, num_words);
+    write_data.assign(slots.size() * store.get_word_bytes(), 0);
+    completion_data.assign(size_t(completion_capacity) * store.get_word_bytes(), 0);
+    callback_word.assign(store.get_word_bytes(), 0);
+}
+
+uint32_t CRamualator2Wrapper::get_word_bytes() const {
+    return store.get_word_bytes();
+}
+
+bool CRamualator2Wrapper::load_hex(const std::string& path) {
+    return store.load_hex(path);
+}
+
+bool CRamualator2Wrapper::load_image(const std::string& path, uint64_t base_addr) {
+    return store.load_image(path, base_addr);
+}
+
+void CRamualator2Wrapper::read_data(int64_t addr, uint8_t* out) const {
+    store.read(addr, out);
+}
+
+uint32_t CRamualator2Wrapper::acquire_slot() {
+    if (free_slot == NO_SLOT) {
+        // Only reached when more requests are in flight than ever before.
+        // Slots are addressed by index, so growing the pool is safe.
+        uint32_t first = slots.size();
+        uint32_t grown = first ? first * 2 : INITIAL_SLOTS;
+        slots.resize(grown);
+        write_data.resize(size_t(grown) * store.get_word_bytes());
+        for (uint32_t i = first; i < grown; i++) {
+            slots[i].next_free = i + 1 < grown ? i + 1 : NO_SLOT;
+        }
+        free_slot = first;
+    }
+    uint32_t index = free_slot;
+    free_slot = slots[index].next_free;
+    return index;
+}
+
+void CRamualator2Wrapper::release_slot(uint32_t index) {
+    slots[index].next_free = free_slot;
+    free_slot = index;
+}
+
+void CRamualator2Wrapper::complete(uint32_t index, Ramulator::Request& req) {
+    uint32_t latency = uint32_t(req.depart - req.arrive);
+    uint32_t merged = slots[index].next_merged;
+    // Merged requests never reached a channel.
+    queues.on_complete(slots[index].channel);
+    if (windows && slots[index].detailed) {
+        // Merged requests are the wrapper's doing, not the memory's: only
+        // the transaction is measured.
+        on_detailed_complete(slots[index].is_write, latency);
+    }
+    if (line_size) {
+        OpenLine& open = open_line(slots[index].addr);
+        if (open.slot == index) {
+            // Later requests to the line need a transaction of their own.
+            open.slot = NO_SLOT;
+        }
+    }
+    if (slots[index].prefetch) {
+        // Nobody waits for the prefetch itself: the line is buffered for the
+        // demand reads to come.
+        prefetcher.arrive(prefetcher.line_of(slots[index].addr), index);
+        prefetches_in_flight--;
+        release_slot(index);
+    } else {
+        deliver(index, latency);
+    }
+    // Merged requests complete with the transaction, in the order they
+    // joined it, each with the latency since it did.
+    while (merged != NO_SLOT) {
+        uint32_t next = slots[merged].next_merged;
+        uint32_t delay = slots[merged].merge_delay;
+        deliver(merged, latency > delay ? latency - delay : 0);
+        merged = next;
+    }
+}
+
+void CRamualator2Wrapper::deliver(uint32_t index, uint32_t latency) {
+    // Release the slot before the callback runs: the callback may submit
+    // new requests, which can reuse it or grow the pool.
+    dram_callback_t callback = slots[index].callback;
+    void* ctx = slots[index].ctx;
+    if (slots[index].commit) {
+        // Writes take effect at completion, so that a read completing later
+        // observes them and a read completing earlier does not.
+        store.write(slots[index].addr, &write_data[size_t(index) * store.get_word_bytes()]);
+    }
+    stats.on_complete(slots[index].is_write, latency);
+    if (!callback) {
+        push_completion(slots[index], latency);
+        release_slot(index);
+        num_completed++;
+        num_outstanding--;
+        return;
+    }
+    dram_completion_t done;
+    fill_completion(slots[index], latency, done, callback_word.data());
+    release_slot(index);
+    num_completed++;
+    num_outstanding--;
+    callback(&done, callback_word.data(), ctx);
+}
+
+void CRamualator2Wrapper::fill_completion(const RequestSlot& slot, uint32_t latency,
+                                          dram_completion_t& done, uint8_t* word) const {
+    done.id = slot.id;
+    done.addr = slot.addr;
+    // Completions fire inside the memory system tick, before `cycle` moves.
+    done.cycle = cycle + 1;
+    done.latency = latency;
+    done.is_write = slot.is_write;
+    std::memset(done.reserved, 0, sizeof(done.reserved));
+    // Reads take their data now, so that a write completing before the
+    // next poll does not leak into them.
+    if (slot.is_write) {
+        std::memset(word, 0, store.get_word_bytes());
+    } else {
+        store.read(slot.addr, word);
+    }
+}
+
+void CRamualator2Wrapper::push_completion(const RequestSlot& slot, uint32_t latency) {
+    if (completion_tail - completion_head == completion_capacity) {
+        // The caller fell behind: grow rather than lose completions.
+        grow_completions();
+    }
+    uint32_t k = completion_tail++ & (completion_capacity - 1);
+    fill_completion(slot, latency, completions[k], &completion_data[size_t(k) * store.get_word_bytes()]);
+}
+
+void CRamualator2Wrapper::grow_completions() {
+    uint32_t capacity = completion_capacity ? completion_capacity * 2 : INITIAL_COMPLETIONS;
+    uint32_t word_bytes = store.get_word_bytes();
+    // 32-byte records, so a 64-byte aligned ring never splits one across lines.
+    auto* grown = static_cast<dram_completion_t*>(
+        std::aligned_alloc(64, sizeof(dram_completion_t) * capacity));
+    std::vector<uint8_t> grown_data(size_t(capacity) * word_bytes);
+    uint64_t count = completion_tail - completion_head;
+    for (uint64_t i = 0; i < count; i++) {
+        uint32_t k = (completion_head + i) & (completion_capacity - 1);
+        grown[i] = completions[k];
+        std::memcpy(&grown_data[i * word_bytes], &completion_data[size_t(k) * word_bytes], word_bytes);
+    }
+    std::free(completions);
+    completions = grown;
+    completion_data.swap(grown_data);
+    completion_capacity = capacity;
+    completion_head = 0;
+    completion_tail = count;
+}
+
+uint32_t CRamualator2Wrapper::poll_completions(dram_completion_t* out, uint8_t* data, uint32_t max) {
+    uint32_t word_bytes = store.get_word_bytes();
+    uint32_t count = uint32_t(std::min<uint64_t>(max, completion_tail - completion_head));
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t k = completion_head++ & (completion_capacity - 1);
+        out[i] = completions[k];
+        if (data) {
+            std::memcpy(data + size_t(i) * word_bytes, &completion_data[size_t(k) * word_bytes], word_bytes);
+        }
+    }
+    return count;
+}
+
+uint32_t CRamualator2Wrapper::peek_completions(const dram_completion_t** records, const uint8_t** data) const {
+    uint32_t start = uint32_t(completion_head & (completion_capacity - 1));
+    // Up to the end of the ring: the rest, if any, wraps around to its start.
+    uint32_t count = uint32_t(std::min<uint64_t>(completion_tail - completion_head, completion_capacity - start));
+    *records = completions + start;
+    if (data) {
+        *data = completion_data.data() + size_t(start) * store.get_word_bytes();
+    }
+    return count;
+}
+
+void CRamualator2Wrapper::release_completions(uint32_t count) {
+    completion_head += std::min<uint64_t>(count, completion_tail - completion_head);
+}
+
+uint32_t CRamualator2Wrapper::get_stats(dram_stats_t* out, uint32_t size) const {
+    dram_stats_t snapshot{};
+    snapshot.struct_size = sizeof(dram_stats_t);
+    snapshot.cycle = cycle;
+    snapshot.memory_cycle = memory_cycle;
+    stats.snapshot(snapshot);
+    if (windows) {
+        windows->estimate(snapshot);
+    }
+    snapshot.outstanding = num_outstanding;
+    uint64_t word_bytes = store.get_word_bytes();
+    snapshot.bytes_read = snapshot.reads_completed * word_bytes;
+    snapshot.bytes_written = snapshot.writes_completed * word_bytes;
+    double elapsed_ns = double(memory_cycle) * double(get_memory_tCK());
+    if (elapsed_ns > 0) {
+        snapshot.bandwidth = double(snapshot.bytes_read + snapshot.bytes_written) / elapsed_ns;
+    }
+    // A binding built against an older, shorter layout gets its prefix.
+    std::memcpy(out, &snapshot, std::min<size_t>(size, sizeof(dram_stats_t)));
+    return sizeof(dram_stats_t);
+}
+
+bool CRamualator2Wrapper::dump_latency_csv(const std::string& path) const {
+    return stats.dump_csv(path);
+}
+
+void CRamualator2Wrapper::set_latency_csv(const std::string& path) {
+    latency_csv = path;
+}
+
+bool CRamualator2Wrapper::start_sampling(const std::string& path, uint64_t interval, bool binary) {
+    stop_sampling();
+    std::FILE* file = std::fopen(path.c_str(), binary ? "wb" : "w");
+    if (!file) {
+        return false;
+    }
+    sampler = std::make_unique<DramSampler>(file, interval, store.get_word_bytes(), binary, sampling_totals(cycle));
+    return true;
+}
+
+void CRamualator2Wrapper::stop_sampling() {
+    if (!sampler) {
+        return;
+    }
+    if (sampler->mid_window()) {
+        sampler->record(sampling_totals(cycle));
+    }
+    if (sampler->dropped()) {
+        std::fprintf(stderr, "DRAM sampling fell behind: %" PRIu64 " samples dropped\n", sampler->dropped());
+    }
+    sampler.reset();
+}
+
+bool CRamualator2Wrapper::start_trace(const std::string& path) {
+    stop_trace();
+    auto trace = std::make_unique<TraceRecorder>();
+    if (!trace->open(path)) {
+        return false;
+    }
+    recorder = std::move(trace);
+    return true;
+}
+
+bool CRamualator2Wrapper::stop_trace() {
+    if (!recorder) {
+        return true;
+    }
+    bool ok = recorder->close();
+    recorder.reset();
+    return ok;
+}
+
+namespace {
+
+// Checkpoint files start with this, then the sizes of the structs saved raw,
+// so that one written by another build is rejected rather than misread.
+const char CHECKPOINT_MAGIC[8] = {'D', 'R', 'A', 'M', 'C', 'K', 'P', '\1'};
+
+struct CheckpointHeader {
+  char magic[8];
+  uint32_t stats_size;
+  uint32_t completion_size;
+};
+
+struct CheckpointClocks {
+  uint64_t cycle;
+  uint64_t memory_cycle;
+  uint64_t core_period;
+  uint64_t clock_phase;
+  uint64_t num_completed;
+  uint64_t next_id;
+  uint64_t num_completions;
+};
+
+template <typename T>
+bool write_raw(std::FILE* file, const T* value, size_t count = 1) {
+    static_assert(std::is_trivially_copyable<T>::value, "saved as raw bytes");
+    return std::fwrite(value, sizeof(T), count, file) == count;
+}
+
+template <typename T>
+bool read_raw(std::FILE* file, T* value, size_t count = 1) {
+    static_assert(std::is_trivially_copyable<T>::value, "saved as raw bytes");
+    return std::fread(value, sizeof(T), count, file) == count;
+}
+
+} // namespace
+
+bool CRamualator2Wrapper::checkpoint(const std::string& path) {
+    while (num_outstanding || prefetches_in_flight) {
+        tick_n(1, false);
+    }
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    CheckpointHeader header{{}, sizeof(DramStats), sizeof(dram_completion_t)};
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    uint64_t count = completion_tail - completion_head;
+    CheckpointClocks clocks{cycle, memory_cycle, core_period, clock_phase, num_completed, next_id, count};
+    bool ok = write_raw(file, &header) && write_raw(file, &clocks) && write_raw(file, &stats) && store.save(file);
+    // Polled completions not taken yet, oldest first, each with its word.
+    uint32_t word_bytes = store.get_word_bytes();
+    for (uint64_t i = 0; ok && i < count; i++) {
+        uint32_t k = (completion_head + i) & (completion_capacity - 1);
+        ok = write_raw(file, &completions[k]) && write_raw(file, &completion_data[size_t(k) * word_bytes], word_bytes);
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+bool CRamualator2Wrapper::restore(const std::string& path) {
+    if (num_outstanding || prefetches_in_flight) {
+        return false;
+    }
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    // Read in full before anything is replaced, so that a truncated or
+    // malformed file leaves the instance as it was.
+    CheckpointHeader header;
+    CheckpointClocks clocks;
+    DramStats restored_stats;
+    BackingStore restored_store;
+    bool ok = read_raw(file, &header) && std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0 &&
+              header.stats_size == sizeof(DramStats) && header.completion_size == sizeof(dram_completion_t) &&
+              read_raw(file, &clocks) && read_raw(file, &restored_stats) && restored_store.load(file);
+    uint32_t word_bytes = restored_store.get_word_bytes();
+    std::vector<dram_completion_t> queued;
+    std::vector<uint8_t> queued_data;
+    for (uint64_t i = 0; ok && i < clocks.num_completions; i++) {
+        // Grown as read, so that a corrupt count fails at the end of the
+        // file rather than allocating it up front.
+        queued.emplace_back();
+        queued_data.resize(queued_data.size() + word_bytes);
+        ok = read_raw(file, &queued.back()) && read_raw(file, &queued_data[size_t(i) * word_bytes], word_bytes);
+    }
+    std::fclose(file);
+    if (!ok) {
+        return false;
+    }
+
+    // Its windows would straddle the jump in the counters.
+    stop_sampling();
+    store.swap(restored_store);
+    stats = restored_stats;
+    // Size the buffers holding words for the store just loaded.
+    write_data.assign(slots.size() * word_bytes, 0);
+    callback_word.assign(word_bytes, 0);
+    completion_head = completion_tail = 0;
+    while (completion_capacity < queued.size()) {
+        grow_completions();
+    }
+    completion_data.assign(size_t(completion_capacity) * word_bytes, 0);
+    std::copy(queued.begin(), queued.end(), completions);
+    std::copy(queued_data.begin(), queued_data.end(), completion_data.begin());
+    completion_tail = queued.size();
+    cycle = clocks.cycle;
+    memory_cycle = clocks.memory_cycle;
+    // The clock ratio is that of the checkpoint, against the tCK of this
+    // instance's config, which may differ.
+    core_period = clocks.core_period;
+    memory_period = std::max<uint64_t>(1, std::llround(double(get_memory_tCK()) * 1e6));
+    clock_phase = clocks.clock_phase % memory_period;
+    num_completed = clocks.num_completed;
+    next_id = clocks.next_id;
+    // As cold as the memory system.
+    prefetcher.clear();
+    return true;
+}
+
+void CRamualator2Wrapper::sample(uint64_t at_cycle) {
+    if (sampler && sampler->tick(num_outstanding)) {
+        sampler->record(sampling_totals(at_cycle));
+    }
+}
+
+DramSampler::Totals CRamualator2Wrapper::sampling_totals(uint64_t at_cycle) const {
+    return {at_cycle, memory_cycle, stats.reads_completed(), stats.writes_completed(),
+            stats.rejections(), stats.latency_sum(), num_outstanding};
+}
+
 void CRamualator2Wrapper::finish(){
+    // The fast memory keeps no statistics of its own.
+    if (fast_memory) {
+        return;
+    }
+    for (Channel& channel : channels) {
+        channel.memory->finish();
+    }
+    if (!channels.empty()) {
+        return;
+    }
     ramulator2_frontend->finalize();
     ramulator2_memorysystem->finalize();
 }
 
 void CRamualator2Wrapper::frontend_tick(){
-    ramulator2_frontend->tick();
+    // Channels tick both halves in `memory_system_tick`.
+    if (!fast_memory && channels.empty() && ramulator_active()) {
+        ramulator2_frontend->tick();
+    }
 }
 
 void CRamualator2Wrapper::memory_system_tick(){
-    ramulator2_memorysystem->tick();
+    if (fast_memory) {
+        fast_memory->tick();
+    } else {
+        if (ramulator_active()) {
+            if (channels.empty()) {
+                ramulator2_memorysystem->tick();
+            } else {
+                ramulator_tick();
+            }
+        }
+        sampled_tick();
+    }
+    if (hits_tail != hits_head) {
+        deliver_prefetch_hits();
+    }
+    memory_cycle++;
+    cycle++;
+    sample(cycle);
 }
 
-CRamualator2Wrapper::~CRamualator2Wrapper() {
-    if(ramulator2_frontend) {
-        delete ramulator2_frontend;
-        ramulator2_frontend = nullptr;
+void CRamualator2Wrapper::set_core_clock(double core_tck){
+    core_period = core_tck > 0 ? std::llround(core_tck * 1e6) : 0;
+    memory_period = std::max<uint64_t>(1, std::llround(double(get_memory_tCK()) * 1e6));
+    clock_phase = 0;
+}
+
+uint64_t CRamualator2Wrapper::get_memory_cycle() const {
+    return memory_cycle;
+}
+
+void CRamualator2Wrapper::advance(){
+    uint64_t ticks = 1;
+    if (core_period) {
+        // A fractional accumulator: the memory clock ticks whenever it
+        // falls a whole period behind the core clock.
+        clock_phase += core_period;
+        ticks = clock_phase / memory_period;
+        clock_phase -= ticks * memory_period;
     }
-    if(ramulator2_memorysystem) {
-        delete ramulator2_memorysystem;
-        ramulator2_memorysystem = nullptr;
+    for (; ticks; ticks--) {
+        if (fast_memory) {
+            fast_memory->tick();
+        } else {
+            if (ramulator_active()) {
+                ramulator_tick();
+            }
+            sampled_tick();
+        }
+        if (hits_tail != hits_head) {
+            deliver_prefetch_hits();
+        }
+        memory_cycle++;
+        sample(cycle + 1);
+    }
+    cycle++;
+}
+
+uint64_t CRamualator2Wrapper::tick_n(uint64_t n, bool stop_on_completion){
+    uint64_t completed_before = num_completed;
+    uint64_t advanced = 0;
+    while (advanced < n) {
+        advance();
+        advanced++;
+        if (stop_on_completion && num_completed != completed_before) {
+            break;
+        }
     }
+    return advanced;
+}
+
+uint64_t CRamualator2Wrapper::run_until(uint64_t target_cycle, bool stop_on_completion){
+    if (target_cycle <= cycle) {
+        return 0;
+    }
+    return tick_n(target_cycle - cycle, stop_on_completion);
+}
+
+uint64_t CRamualator2Wrapper::get_cycle() const {
+    return cycle;
+}
+
+uint64_t CRamualator2Wrapper::next_event_cycle() const {
+    if (!num_outstanding) {
+        return DRAM_NO_EVENT;
+    }
+    // Memory ticks until the first completion: a read served by the
+    // prefetch buffer is due in the tick that reaches `due`, as the queue is
+    // in due order.
+    uint64_t ticks = UINT64_MAX;
+    if (hits_tail != hits_head) {
+        uint64_t due = prefetch_hits[hits_head & (prefetch_hits.size() - 1)].due;
+        ticks = due > memory_cycle + 1 ? due - memory_cycle : 1;
+    }
+    if (fast_memory) {
+        ticks = std::min(ticks, fast_memory->cycles_to_next());
+    } else if (num_outstanding != hits_tail - hits_head) {
+        // Ramulator2 does not expose when an in-flight request will depart,
+        // so any cycle may deliver a completion while one is outstanding.
+        // Refreshes are internal to the controller and invisible to the caller.
+        return cycle + 1;
+    }
+    if (ticks == UINT64_MAX) {
+        return cycle + 1;
+    }
+    if (!core_period) {
+        return cycle + ticks;
+    }
+    // The first `advance` whose accumulated phase covers `ticks` periods.
+    uint64_t remaining = ticks * memory_period - clock_phase;
+    return cycle + (remaining + core_period - 1) / core_period;
+}
+
+uint64_t CRamualator2Wrapper::skip_to(uint64_t target_cycle){
+    // Prefetches complete unobserved, but the memory must tick them out
+    // before its clock can freeze.
+    while (!num_outstanding && prefetches_in_flight && cycle < target_cycle) {
+        tick_n(1, false);
+    }
+    if (num_outstanding) {
+        run_until(target_cycle, true);
+        return cycle;
+    }
+    if (cycle < target_cycle) {
+        // Nothing is in flight: only the wrapper clock moves. The controller
+        // clock is frozen over the skipped stretch, so no refresh is modeled
+        // there, but latencies of later requests are still measured in
+        // controller cycles and stay consistent.
+        cycle = target_cycle;
+    }
+    return cycle;
+}
+
+void CRamualator2Wrapper::end_run() {
+    stop_sampling();
+    if (!stop_trace()) {
+        std::fprintf(stderr, "cannot write the DRAM trace\n");
+    }
+    if (!latency_csv.empty() && !dump_latency_csv(latency_csv)) {
+        std::fprintf(stderr, "cannot write DRAM latencies to %s\n", latency_csv.c_str());
+    }
+}
+
+CRamualator2Wrapper::~CRamualator2Wrapper() {
+    end_run();
+    disconnect();
+    std::free(completions);
 }
 
 extern "C" {
@@ -57,22 +1121,29 @@ extern "C" {
         delete obj;
     }
     
-    // Wrap init method: pass config path as C string
-    void dram_init(CRamualator2Wrapper* obj, const char* config_path) {
-        obj->init(std::string(config_path));
+    // Factory: an instance simulating a fixed-latency memory, see FastMemory.h
+    CRamualator2Wrapper* dram_new_fast() {
+        return new CRamualator2Wrapper(true);
+    }
+
+    // Wrap init method: pass the config path, or inline YAML, as C string
+    void dram_init(CRamualator2Wrapper* obj, const char* config) {
+        obj->init(std::string(config));
     }
     
+    // Same, with the AddrMapper impl of the config replaced by `mapper`
+    void dram_init_mapped(CRamualator2Wrapper* obj, const char* config, const char* mapper) {
+        obj->init(std::string(config), std::string(mapper));
+    }
+
     // Wrap get_memory_tCK method
     float get_memory_tCK(CRamualator2Wrapper* obj) {
         return obj->get_memory_tCK();
     }
     
     // Wrap send_request method
-    bool send_request(CRamualator2Wrapper* obj, int64_t addr, bool is_write, void (*callback)(Ramulator::Request*, void*), void* ctx) {
-        return obj->send_request(addr, is_write, 
-            [callback, ctx](Ramulator::Request& req) {
-                callback(&req, ctx);
-            });
+    bool send_request(CRamualator2Wrapper* obj, int64_t addr, bool is_write, dram_callback_t callback, void* ctx) {
+        return obj->send_request(addr, is_write, callback, ctx);
     }
     
     // Wrap finish method
@@ -88,5 +1159,256 @@ extern "C" {
     void memory_system_tick(CRamualator2Wrapper* obj) {
         obj->memory_system_tick();
     }
+
+    // Batched tick: frontend and memory system advance together for n cycles
+    uint64_t dram_tick_n(CRamualator2Wrapper* obj, uint64_t n, bool stop_on_completion) {
+        return obj->tick_n(n, stop_on_completion);
+    }
+
+    // Batched tick until the memory cycle counter reaches `cycle`
+    uint64_t dram_run_until(CRamualator2Wrapper* obj, uint64_t cycle, bool stop_on_completion) {
+        return obj->run_until(cycle, stop_on_completion);
+    }
+
+    uint64_t dram_get_cycle(CRamualator2Wrapper* obj) {
+        return obj->get_cycle();
+    }
+
+    // Run the memory system at its own clock against a core clock (ns)
+    void dram_set_core_clock(CRamualator2Wrapper* obj, double core_tck) {
+        obj->set_core_clock(core_tck);
+    }
+
+    uint64_t dram_get_memory_cycle(CRamualator2Wrapper* obj) {
+        return obj->get_memory_cycle();
+    }
+
+    // Earliest cycle at which a completion may arrive (UINT64_MAX if idle)
+    uint64_t dram_next_event_cycle(CRamualator2Wrapper* obj) {
+        return obj->next_event_cycle();
+    }
+
+    // Fast-forward to `cycle`, stopping early at the first completion
+    uint64_t dram_skip_to(CRamualator2Wrapper* obj, uint64_t cycle) {
+        return obj->skip_to(cycle);
+    }
+
+    // Word size (bytes) and depth (words, 0 if unknown) of the backing store
+    void dram_config_store(CRamualator2Wrapper* obj, uint32_t word_bytes, uint64_t num_words) {
+        obj->config_store(word_bytes, num_words);
+    }
+
+    // Preload the backing store from a hex file, false if it cannot be opened or is not text
+    bool dram_load_hex(CRamualator2Wrapper* obj, const char* path) {
+        return obj->load_hex(std::string(path));
+    }
+
+    // Write request carrying one word of data, committed at completion
+    bool dram_send_write(CRamualator2Wrapper* obj, int64_t addr, const uint8_t* data, dram_callback_t callback, void* ctx) {
+        return obj->send_write(addr, data, callback, ctx);
+    }
+
+    // Copy one word of the backing store into `out`
+    void dram_read_data(CRamualator2Wrapper* obj, int64_t addr, uint8_t* out) {
+        obj->read_data(addr, out);
+    }
+
+    // Preload a raw *.bin image (mapped, not parsed), or a hex file, at word `base_addr`
+    bool dram_load_image(CRamualator2Wrapper* obj, const char* path, uint64_t base_addr) {
+        return obj->load_image(std::string(path), base_addr);
+    }
+
+    // Submit n requests in one call. Bit i of `accepted` is set if request i
+    // was accepted; `data` holds one word per request, or is null.
+    uint32_t dram_send_requests(CRamualator2Wrapper* obj, const int64_t* addrs, const bool* is_write, uint32_t n,
+                                const uint8_t* data, dram_callback_t callback, void* ctx, uint64_t* accepted) {
+        return obj->send_requests(addrs, is_write, n, data, callback, ctx, accepted);
+    }
+
+    // Submit one request, returning its ID (0 if rejected); data may be null
+    uint64_t dram_submit(CRamualator2Wrapper* obj, int64_t addr, bool is_write, const uint8_t* data, dram_callback_t callback, void* ctx) {
+        return obj->submit(addr, is_write, data, callback, ctx);
+    }
+
+    uint64_t dram_next_request_id(CRamualator2Wrapper* obj) {
+        return obj->next_request_id();
+    }
+
+    // Drain up to `max` completions of polled (null callback) requests
+    uint32_t dram_poll_completions(CRamualator2Wrapper* obj, dram_completion_t* out, uint8_t* data, uint32_t max) {
+        return obj->poll_completions(out, data, max);
+    }
+
+    // Borrow the oldest polled completions in place, then drop them
+    uint32_t dram_peek_completions(CRamualator2Wrapper* obj, const dram_completion_t** records, const uint8_t** data) {
+        return obj->peek_completions(records, data);
+    }
+
+    void dram_release_completions(CRamualator2Wrapper* obj, uint32_t count) {
+        obj->release_completions(count);
+    }
+
+    // Requests the memory should take before refusing one, see ChannelQueues.h
+    uint32_t dram_queue_free_slots(CRamualator2Wrapper* obj) {
+        return obj->queue_free_slots();
+    }
+
+    uint32_t dram_num_channels(CRamualator2Wrapper* obj) {
+        return obj->num_channels();
+    }
+
+    uint32_t dram_channel_occupancy(CRamualator2Wrapper* obj, uint32_t channel) {
+        return obj->channel_occupancy(channel);
+    }
+
+    // Back to cycle 0 without parsing the config again, see CRamualator2Wrapper.h
+    void dram_reset(CRamualator2Wrapper* obj) {
+        obj->reset();
+    }
+
+    // Prefetch what a hook returns, see CRamualator2Wrapper::set_prefetch_hook
+    void dram_set_prefetch_hook(CRamualator2Wrapper* obj, dram_prefetch_hook_t hook, void* ctx) {
+        obj->set_prefetch_hook(hook, ctx);
+    }
+
+    // Snapshot of the counters, truncated to the `size` bytes of `out`
+    uint32_t dram_get_stats(CRamualator2Wrapper* obj, dram_stats_t* out, uint32_t size) {
+        return obj->get_stats(out, size);
+    }
+
+    // Latency histograms as CSV, now or when the instance is deleted
+    bool dram_dump_latency_csv(CRamualator2Wrapper* obj, const char* path) {
+        return obj->dump_latency_csv(std::string(path));
+    }
+
+    void dram_set_latency_csv(CRamualator2Wrapper* obj, const char* path) {
+        obj->set_latency_csv(std::string(path));
+    }
+
+    // Time series of the memory, written out by a background thread
+    bool dram_start_sampling(CRamualator2Wrapper* obj, const char* path, uint64_t interval, bool binary) {
+        return obj->start_sampling(std::string(path), interval, binary);
+    }
+
+    void dram_stop_sampling(CRamualator2Wrapper* obj) {
+        obj->stop_sampling();
+    }
+
+    // Trace of the accepted requests, encoded by a background thread
+    bool dram_start_trace(CRamualator2Wrapper* obj, const char* path) {
+        return obj->start_trace(std::string(path));
+    }
+
+    bool dram_stop_trace(CRamualator2Wrapper* obj) {
+        return obj->stop_trace();
+    }
+
+    // Save the wrapper's state, draining requests in flight, or load it back
+    bool dram_checkpoint(CRamualator2Wrapper* obj, const char* path) {
+        return obj->checkpoint(std::string(path));
+    }
+
+    bool dram_restore(CRamualator2Wrapper* obj, const char* path) {
+        return obj->restore(std::string(path));
+    }
+
+    uint32_t dram_get_word_bytes(CRamualator2Wrapper* obj) {
+        return obj->get_word_bytes();
+    }
+
+    // Merge requests to the same line, see CRamualator2Wrapper::set_coalescing
+    void dram_set_coalescing(CRamualator2Wrapper* obj, uint64_t line_size, uint64_t write_window) {
+        obj->set_coalescing(line_size, write_window);
+    }
+
+    // Sampled simulation, see CRamualator2Wrapper::set_detailed_windows
+    bool dram_set_detailed_windows(CRamualator2Wrapper* obj, uint64_t period, uint64_t window, uint64_t warmup) {
+        return obj->set_detailed_windows(period, window, warmup);
+    }
+
+    // Channel, rank, ..., column of an address, see AddressMapper.h
+    uint32_t dram_decode_addr(CRamualator2Wrapper* obj, int64_t addr, int64_t* out, uint32_t max) {
+        return obj->decode_addr(addr, out, max);
+    }
+
+    const char* dram_addr_level_name(CRamualator2Wrapper* obj, uint32_t level) {
+        return obj->addr_level_name(level);
+    }
+
+    // Tick several instances in parallel, see DramGroup.h
+    DramGroup* dram_group_new(uint32_t num_threads) {
+        return new DramGroup(num_threads);
+    }
+
+    void dram_group_delete(DramGroup* group) {
+        delete group;
+    }
+
+    void dram_group_add(DramGroup* group, CRamualator2Wrapper* obj) {
+        group->add(obj);
+    }
+
+    void dram_group_tick(DramGroup* group, uint64_t n) {
+        group->tick(n);
+    }
+
+    // All of the above in one table, so that bindings resolve a single symbol
+    const dram_vtable_t* dram_get_vtable() {
+        static const dram_vtable_t vtable = {
+            sizeof(dram_vtable_t),
+            dram_new,
+            dram_delete,
+            dram_init,
+            get_memory_tCK,
+            send_request,
+            finish,
+            frontend_tick,
+            memory_system_tick,
+            dram_tick_n,
+            dram_run_until,
+            dram_get_cycle,
+            dram_next_event_cycle,
+            dram_skip_to,
+            dram_config_store,
+            dram_load_hex,
+            dram_send_write,
+            dram_read_data,
+            dram_load_image,
+            dram_send_requests,
+            dram_submit,
+            dram_next_request_id,
+            dram_poll_completions,
+            dram_group_new,
+            dram_group_delete,
+            dram_group_add,
+            dram_group_tick,
+            dram_set_core_clock,
+            dram_get_memory_cycle,
+            dram_get_stats,
+            dram_dump_latency_csv,
+            dram_set_latency_csv,
+            dram_start_sampling,
+            dram_stop_sampling,
+            dram_start_trace,
+            dram_stop_trace,
+            dram_checkpoint,
+            dram_restore,
+            dram_get_word_bytes,
+            dram_set_coalescing,
+            dram_new_fast,
+            dram_set_detailed_windows,
+            dram_init_mapped,
+            dram_decode_addr,
+            dram_addr_level_name,
+            dram_peek_completions,
+            dram_release_completions,
+            dram_queue_free_slots,
+            dram_num_channels,
+            dram_channel_occupancy,
+            dram_reset,
+            dram_set_prefetch_hook,
+        };
+        return &vtable;
+    }
     
 }
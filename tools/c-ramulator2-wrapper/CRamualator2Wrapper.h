@@ -1,30 +1,561 @@
 #ifndef CRAMUALATOR2WRAPPER_H
 #define CRAMUALATOR2WRAPPER_H
 
+#include "./AddressMapper.h"
+#include "./BackingStore.h"
+#include "./ChannelQueues.h"
+#include "./ConfigCache.h"
+#include "./DetailedWindows.h"
+#include "./DramGroup.h"
+#include "./DramSampler.h"
+#include "./DramStats.h"
+#include "./FastMemory.h"
+#include "./Prefetcher.h"
+#include "./Trace.h"
 #include "base/base.h"
 #include "base/config.h"
 #include "base/request.h"
 #include "frontend/frontend.h"
 #include "memory_system/memory_system.h"
 #include <deque>
+#include <memory>
 #include <unordered_map>
+#include <vector>
+
+// Returned by `next_event_cycle` when nothing is in flight.
+constexpr uint64_t DRAM_NO_EVENT = UINT64_MAX;
+
+// Returned by `submit` when the frontend rejects the request. Accepted
+// requests get IDs from 1 on.
+constexpr uint64_t DRAM_REJECTED = 0;
+
+// One completed request, as delivered by `poll_completions` and passed to
+// completion callbacks. Two records fill a cache line.
+struct dram_completion_t {
+  // ID the request was given on submission.
+  uint64_t id;
+  int64_t addr;
+  // Value of `get_cycle` right after the tick that completed the request.
+  uint64_t cycle;
+  // Memory cycles from arrival to departure.
+  uint32_t latency;
+  bool is_write;
+  uint8_t reserved[3];
+};
+static_assert(sizeof(dram_completion_t) == 32, "bindings mirror this layout");
+
+// Completion callback of the C interface. `data` is one word of the backing
+// store: the word read, as of completion, for reads, and zeros for writes.
+// Both pointers are only valid until the callback returns.
+typedef void (*dram_callback_t)(const dram_completion_t *done,
+                                const uint8_t *data, void *ctx);
 
 class CRamualator2Wrapper {
 
 public:
-  CRamualator2Wrapper() = default;
+  // With `fast`, `init` sets up a `FastMemory` in place of Ramulator2's
+  // frontend and memory system: same interface and backing store, fixed
+  // latencies.
+  explicit CRamualator2Wrapper(bool fast = false) : fast(fast) {}
   ~CRamualator2Wrapper();
-  void init(const std::string &config_path);
+  // `config` is the path to a YAML configuration file, or, if it spans
+  // several lines, the YAML text itself. A fast instance only reads its
+  // `FastMemory` section, if any. A non-empty `mapper` replaces the
+  // `AddrMapper` impl of the config, e.g. "ChRaBaRoCo". A `Channels` section
+  // with a `count` above 1 splits the memory into that many channels, each
+  // a frontend and memory system of the config, ticked in parallel. A
+  // `Prefetcher` section, which a fast instance reads too, sets up the
+  // prefetch stage; see `set_prefetch_hook`.
+  void init(const std::string &config, const std::string &mapper = "");
+  // Return to the state `init` left: cycle 0, nothing in flight, cleared
+  // statistics and backing store, whose word size and depth are kept, and
+  // coalescing, sampled simulation, core clock, prefetch hook, sampling,
+  // trace and latency CSV off, the last three written out first. The config
+  // is not parsed again, but Ramulator2, which cannot be reset, is rebuilt
+  // from it.
+  // Requests in flight are dropped without completing.
+  void reset();
+  bool is_fast() const { return fast; }
   float get_memory_tCK() const;
   bool send_request(int64_t addr, bool is_write,
                     std::function<void(Ramulator::Request &)> callback);
+  // Allocation-free variant: the callback and its context are kept in a
+  // pooled slot owned by the wrapper until the request completes.
+  bool send_request(int64_t addr, bool is_write, dram_callback_t callback,
+                    void *ctx);
+  // Write `data` (one word of the backing store) to `addr`. The data is
+  // committed to the backing store when the request completes.
+  bool send_write(int64_t addr, const uint8_t *data, dram_callback_t callback,
+                  void *ctx);
+  // Same as `send_request` or, with `data`, `send_write`, but returns the
+  // request ID, or `DRAM_REJECTED`. IDs increase by one per accepted request.
+  uint64_t submit(int64_t addr, bool is_write, const uint8_t *data,
+                  dram_callback_t callback, void *ctx);
+  // ID of the next accepted request.
+  uint64_t next_request_id() const;
+  // Merge requests to a line of `line_size` addresses into one transaction
+  // of the memory system: a read joins the read of its line in flight, a
+  // write joins the write of its line sent at most `write_window` cycles
+  // before. A merged request is still accepted, with its own ID, and
+  // completes, with its own completion and data, along with the transaction.
+  // A request of the other type closes the line to merging, so that reads
+  // and writes to it stay ordered. 0, the default, turns coalescing off.
+  // Only requests of the C interface are merged.
+  void set_coalescing(uint64_t line_size, uint64_t write_window);
+  // Sampled simulation: of every `period` memory cycles, only the first
+  // `warmup + window` go through Ramulator2, and requests sent in the rest
+  // go to a `FastMemory` drawing its latencies from those Ramulator2 took in
+  // the last measured `window`. Requests complete where they were sent, so
+  // Ramulator2 keeps ticking past its window until it drains. The windows
+  // give `get_stats` estimates of the run's latency and bandwidth, with
+  // confidence intervals. A `period` of 0 turns it off. Returns false, and
+  // changes nothing, on a fast instance, with requests in flight, or if
+  // `window` is 0 or `warmup + window` exceeds `period`.
+  bool set_detailed_windows(uint64_t period, uint64_t window, uint64_t warmup);
+  // Prefetch the addresses `hook` returns for each demand read, in place of
+  // the config's `Prefetcher` policy, or, with a null `hook`, go back to it.
+  // Prefetches are reads of whole lines the wrapper sends on its own, with
+  // no ID or completion; a demand read whose line arrived completes from
+  // the buffer, and one whose line is on its way completes with it. Only
+  // requests of the C interface are prefetched for, and the trace records
+  // none of the prefetches.
+  void set_prefetch_hook(dram_prefetch_hook_t hook, void *ctx);
+  // Decode `addr` into its index at each level of the DRAM organization,
+  // channel first, as the config's address mapper does; see
+  // `AddressMapper`. With `Channels`, the channel level counts the
+  // channels of the config's `org`, if several, times the channels the
+  // wrapper dispatches to, the latter varying fastest. Writes at most `max` levels to `out` and returns the
+  // number of levels, 0 if the config's standard or mapper is not modeled.
+  uint32_t decode_addr(int64_t addr, int64_t *out, uint32_t max) const;
+  // Name of a level of `decode_addr`, or null past the last one.
+  const char *addr_level_name(uint32_t level) const;
+  // Requests the memory is expected to take before it refuses one, so that
+  // a caller can hold back requests rather than retry rejected ones: exact
+  // for the fast memory, and for Ramulator2, whose buffers are not exposed,
+  // estimated per channel; see `ChannelQueues`.
+  uint32_t queue_free_slots() const;
+  // Channels of the memory: those of the config's `org`, if the address
+  // mapper models it, times those of `Channels`, numbered as the channel
+  // level of `decode_addr`.
+  uint32_t num_channels() const;
+  // Transactions in flight in `channel`, 0 past the last one.
+  uint32_t channel_occupancy(uint32_t channel) const;
+  // Requests submitted with a null callback are polled: on completion they
+  // are appended to a ring instead, which this drains, oldest first, into
+  // `out`. If `data` is not null, it receives one word per completion: the
+  // word read, as of completion, for reads, and zeros for writes. Returns
+  // the number of completions copied, at most `max`.
+  uint32_t poll_completions(dram_completion_t *out, uint8_t *data,
+                            uint32_t max);
+  // The same without copying: point `records`, and `data` if not null, at
+  // the oldest polled completions and their words, in place in the ring,
+  // and return how many follow contiguously, which may be fewer than are
+  // queued when the ring wraps around. They stay queued, and the pointers
+  // valid, until `release_completions` drops them or the next tick.
+  uint32_t peek_completions(const dram_completion_t **records,
+                            const uint8_t **data) const;
+  // Drop the `count` oldest polled completions, at most as many as queued.
+  void release_completions(uint32_t count);
+  // Submit `n` requests at once, all with the same callback and context.
+  // `data` holds one word per request, used by writes only, or is null for
+  // timing-only writes. Bit `i` of `accepted`, which holds `(n + 63) / 64`
+  // words, is set if request `i` was accepted. Returns the number accepted.
+  // Accepted requests get consecutive IDs, in order, from the value of
+  // `next_request_id` before the call.
+  uint32_t send_requests(const int64_t *addrs, const bool *is_write, uint32_t n,
+                         const uint8_t *data, dram_callback_t callback,
+                         void *ctx, uint64_t *accepted);
+  // Word size and depth of the backing store. Drops its data.
+  void config_store(uint32_t word_bytes, uint64_t num_words);
+  // Word size of the backing store, as configured or restored.
+  uint32_t get_word_bytes() const;
+  bool load_hex(const std::string &path);
+  // Preload a raw image if `path` ends in `.bin`, or else a hex file, at
+  // word `base_addr`.
+  bool load_image(const std::string &path, uint64_t base_addr);
+  // Copy the word at `addr` out of the backing store.
+  void read_data(int64_t addr, uint8_t *out) const;
+  // Copy a snapshot of the counters into `out`, or as much of it as fits
+  // in `size` bytes. Cheap enough to sample mid-run. Returns the size of the
+  // library's `dram_stats_t`.
+  uint32_t get_stats(dram_stats_t *out, uint32_t size) const;
+  // Write the read and write latency histograms to `path` as CSV. Returns
+  // false if it cannot be opened.
+  bool dump_latency_csv(const std::string &path) const;
+  // Dump the histograms to `path` when the wrapper is destroyed, i.e. at
+  // the end of the run. An empty path, the default, dumps nothing.
+  void set_latency_csv(const std::string &path);
+  // Record a `dram_sample_t` every `interval` memory cycles, written to
+  // `path` by a background thread, as CSV or, if `binary` is set, as raw
+  // records. Bytes are counted in words of the store as configured at the
+  // time of the call. Replaces any sampling in progress. Returns false if
+  // `path` cannot be opened.
+  bool start_sampling(const std::string &path, uint64_t interval, bool binary);
+  // Record the window in progress, if any, and write out every sample.
+  // Also done when the wrapper is destroyed.
+  void stop_sampling();
+  // Record every accepted request, with its cycle, address, type and ID, to
+  // `path` in the binary format of `TraceWriter`, encoded by a background
+  // thread. Replaces any recording in progress. Returns false if `path`
+  // cannot be created.
+  bool start_trace(const std::string &path);
+  // Write out every record and close the trace. Also done when the wrapper
+  // is destroyed. Returns false if anything failed to be written.
+  bool stop_trace();
+  // Save the state the wrapper owns to `path`: clocks, request IDs, stats,
+  // polled completions not taken yet, and the backing store. Ramulator2's
+  // queues and bank state cannot be saved, so requests in flight are
+  // drained first, ticking until they complete: checkpointing advances the
+  // clock and runs their callbacks, as ticking would. Neither are the
+  // detailed windows saved. Returns false if `path` cannot be written.
+  bool checkpoint(const std::string &path);
+  // Load a checkpoint into this initialized instance, which must have no
+  // request in flight. The memory system itself starts cold. Returns false,
+  // leaving the instance unchanged, if the file cannot be read or was not
+  // written by this library build. Stops any sampling in progress.
+  bool restore(const std::string &path);
   void finish();
   void frontend_tick();
   void memory_system_tick();
+  // Clock the memory system at its own period, `get_memory_tCK`, against a
+  // core clock of period `core_tck` ns. A cycle of the wrapper, as counted by
+  // `get_cycle` and advanced by the calls below, is then a core cycle, in
+  // which the memory system ticks as many times as its cycles fit: none,
+  // once, or more. 0 goes back to one memory tick per cycle.
+  void set_core_clock(double core_tck);
+  // Number of memory system ticks since init.
+  uint64_t get_memory_cycle() const;
+  // Advance frontend and memory system together for up to `n` cycles.
+  // Returns the number of cycles actually advanced, which is smaller than
+  // `n` only if `stop_on_completion` is set and a request completed.
+  uint64_t tick_n(uint64_t n, bool stop_on_completion);
+  // Advance until the cycle counter reaches `cycle`.
+  uint64_t run_until(uint64_t target_cycle, bool stop_on_completion);
+  uint64_t get_cycle() const;
+  // Earliest cycle at which a completion may be observed, or
+  // `DRAM_NO_EVENT` if no request is in flight. Exact on `FastMemory` and
+  // for reads served by the prefetch buffer, the next cycle otherwise while
+  // Ramulator2 holds a request. Generated simulators only ask after a cycle
+  // in which no module was triggered, and never while a DRAM response is
+  // pending.
+  uint64_t next_event_cycle() const;
+  // Advance to `target_cycle`, never past the first completion.
+  // Returns the cycle actually reached.
+  uint64_t skip_to(uint64_t target_cycle);
 
   std::string config_path;
-  Ramulator::IFrontEnd *ramulator2_frontend;
-  Ramulator::IMemorySystem *ramulator2_memorysystem;
+  Ramulator::IFrontEnd *ramulator2_frontend = nullptr;
+  Ramulator::IMemorySystem *ramulator2_memorysystem = nullptr;
+
+private:
+  static constexpr uint32_t NO_SLOT = UINT32_MAX;
+  static constexpr uint32_t INITIAL_SLOTS = 1024;
+  static constexpr uint32_t INITIAL_COMPLETIONS = 256;
+  static constexpr uint32_t OPEN_LINE_BITS = 10;
+
+  struct RequestSlot {
+    dram_callback_t callback;
+    void *ctx;
+    int64_t addr;
+    uint64_t id;
+    bool is_write;
+    // Commit this slot's word of `write_data` to `store` on completion.
+    bool commit;
+    uint32_t next_free;
+    // Requests merged into this slot's transaction, chained in the order
+    // they joined, and the last of them, or this slot.
+    uint32_t next_merged;
+    uint32_t last_merged;
+    // Memory cycles between the transaction and this request joining it.
+    uint32_t merge_delay;
+    // The transaction went to Ramulator2 rather than to the sampling model.
+    bool detailed;
+    // Channel of the transaction, in `queues`.
+    uint32_t channel;
+    // A prefetch's transaction: no request of its own, only those merged
+    // into it.
+    bool prefetch;
+  };
+
+  // A demand read served from a line the prefetcher holds, at `due`.
+  struct PrefetchHit {
+    uint64_t due;
+    uint32_t slot;
+  };
+
+  // The last transaction sent to the memory system for `line`, while in
+  // flight; `slot` is NO_SLOT once it completes.
+  struct OpenLine {
+    uint64_t line;
+    uint64_t cycle;
+    uint64_t memory_cycle;
+    uint32_t slot;
+    bool is_write;
+  };
+
+  // Hand a request to the frontend, or to the fast memory, or, if not
+  // `detailed`, to the sampling model.
+  bool enqueue(int64_t addr, bool is_write, bool detailed,
+               std::function<void(Ramulator::Request &)> callback);
+  // Whether a request sent now goes to Ramulator2, with sampling or not.
+  bool detailed_now() const { return !windows || windows->detailed(); }
+  // Whether Ramulator2 ticks this memory cycle: always, unless sampling
+  // outside a detailed window with nothing left in it.
+  bool ramulator_active() const {
+    return detailed_now() || ramulator_outstanding;
+  }
+  // Set up this instance's own frontend and memory system, or fast memory.
+  void connect(YAML::Node &config);
+  // Delete Ramulator2's frontend and memory system, if any.
+  void disconnect();
+  // Write out what a run records: its samples, trace and latency CSV.
+  void end_run();
+  // One tick of Ramulator2, frontend then memory system, of every channel.
+  void ramulator_tick();
+  // Channel of `addr` with `Channels`, and its address within the channel:
+  // the interleave units of the other channels taken out.
+  uint32_t channel_of(int64_t addr) const {
+    return uint32_t((uint64_t(addr) / interleave) % channels.size());
+  }
+  int64_t channel_addr(int64_t addr) const {
+    uint64_t unit = uint64_t(addr) / interleave;
+    return int64_t((unit / channels.size()) * interleave + uint64_t(addr) % interleave);
+  }
+  // Called first by the completion lambdas with `Channels`: while the
+  // channels tick, queue `req` to its channel and return true.
+  bool defer(int64_t addr, Ramulator::Request &req);
+  // Run the completions the channels deferred in the last tick, channel by
+  // channel, each in the order its memory completed them.
+  void deliver_channels();
+  // Account a completion of Ramulator2 to the detailed windows.
+  void on_detailed_complete(bool is_write, uint32_t latency);
+  // The sampling half of a memory tick: the model's, and the windows'.
+  void sampled_tick();
+  // Channel of `addr`, in `queues`, with its levels written to `decoded`
+  // if the mapper models the config.
+  uint32_t locate(int64_t addr, int64_t *decoded) const;
+  // Count a row switch if a transaction, `decoded` to `channel`, goes to
+  // another row than the last one of its bank.
+  void track_row(const int64_t *decoded, uint32_t channel);
+  uint32_t acquire_slot();
+  void release_slot(uint32_t index);
+  // Take a slot for a request of the C interface, with the next ID.
+  uint32_t fill_slot(int64_t addr, bool is_write, const uint8_t *data,
+                     dram_callback_t callback, void *ctx);
+  // Send the transaction of slot `index` to the memory. Returns false if
+  // refused.
+  bool transact(uint32_t index);
+  // Chain slot `index` to the transaction of slot `first`, which it joins
+  // `delay` memory cycles after it was sent.
+  void join(uint32_t first, uint32_t index, uint32_t delay);
+  // Account an accepted request of the C interface, and return its ID.
+  uint64_t accept(int64_t addr, bool is_write);
+  // A request of the C interface that neither the prefetcher nor
+  // coalescing took: one transaction of its own.
+  uint64_t send(int64_t addr, bool is_write, const uint8_t *data,
+                dram_callback_t callback, void *ctx);
+  void complete(uint32_t index, Ramulator::Request &req);
+  // Complete the request of one slot, `latency` memory cycles after it
+  // arrived.
+  void deliver(uint32_t index, uint32_t latency);
+  // Fill in `done`, and `word` with its data, for a completed request.
+  void fill_completion(const RequestSlot &slot, uint32_t latency,
+                       dram_completion_t &done, uint8_t *word) const;
+  void push_completion(const RequestSlot &slot, uint32_t latency);
+  void grow_completions();
+  // Merge a request into the transaction in flight for its line. Returns
+  // its ID, or `DRAM_REJECTED` if it cannot be merged.
+  uint64_t coalesce(int64_t addr, bool is_write, const uint8_t *data,
+                    dram_callback_t callback, void *ctx);
+  // Serve a demand read from the line the prefetcher holds or is reading.
+  // Returns its ID, or `DRAM_REJECTED` if the line is not buffered.
+  uint64_t take_prefetched(int64_t addr, dram_callback_t callback, void *ctx);
+  // Send the prefetches a demand read of `addr` triggers.
+  void prefetch(int64_t addr);
+  // Complete the demand reads served from the buffer that are due by the
+  // end of this memory tick.
+  void deliver_prefetch_hits();
+  OpenLine &open_line(int64_t addr) {
+    uint64_t line = uint64_t(addr) / line_size;
+    return open_lines[(line * 0x9E3779B97F4A7C15ull) >> (64 - OPEN_LINE_BITS)];
+  }
+
+  // Slots of in-flight C requests. The completion lambda captures only
+  // `this` and the slot index, which fits in std::function's small buffer,
+  // so neither submission nor Ramulator's internal copies allocate.
+  std::vector<RequestSlot> slots;
+  uint32_t free_slot = NO_SLOT;
+  // Pending write data, one word per slot.
+  std::vector<uint8_t> write_data;
+  // The word passed to a completion callback.
+  std::vector<uint8_t> callback_word;
+
+  bool fast = false;
+  // The config `init` was given, which `reset` rebuilds the memory from.
+  YAML::Node config;
+  std::unique_ptr<FastMemory> fast_memory;
+  BackingStore store;
+  AddressMapper mapper;
+  // Row of the last transaction sent to each bank, -1 if none.
+  std::vector<int64_t> bank_rows;
+  ChannelQueues queues;
+  DramStats stats;
+  std::string latency_csv;
+  std::unique_ptr<DramSampler> sampler;
+  std::unique_ptr<TraceRecorder> recorder;
+
+  // One channel of a `Channels` memory: an instance whose frontend and
+  // memory system take the requests of its interleave units, bypassing its
+  // slots, and the completions it made while ticking, on its thread. A
+  // line each, as threads push to them side by side.
+  struct alignas(64) Channel {
+    std::unique_ptr<CRamualator2Wrapper> memory;
+    std::vector<Ramulator::Request> done;
+  };
+  // Empty without `Channels`. `channel_group` ticks the channels; declared
+  // after them, it joins its threads before they go.
+  std::vector<Channel> channels;
+  uint64_t interleave = 0;
+  bool delivering = false;
+  std::unique_ptr<DramGroup> channel_group;
+
+  // Sampled simulation, off while `windows` is null. `ramulator_outstanding`
+  // counts the requests in flight in Ramulator2 meanwhile.
+  std::unique_ptr<DetailedWindows> windows;
+  std::unique_ptr<FastMemory> model;
+  uint64_t ramulator_outstanding = 0;
+
+  // Coalescing, off while `line_size` is 0. A line maps to one entry of
+  // `open_lines` by hash, and lines sharing an entry evict each other.
+  uint64_t line_size = 0;
+  uint64_t write_window = 0;
+  std::vector<OpenLine> open_lines;
+
+  // Prefetching, off unless the config or a hook turns it on. Prefetches in
+  // flight hold slots but are not outstanding requests. Demand reads served
+  // from the buffer wait in a ring, in the order they are due, from
+  // `hits_head` to `hits_tail`; its capacity is a power of two.
+  Prefetcher prefetcher;
+  uint64_t prefetches_in_flight = 0;
+  std::vector<PrefetchHit> prefetch_hits;
+  uint64_t hits_head = 0;
+  uint64_t hits_tail = 0;
+
+  uint64_t next_id = 1;
+  // Completions of polled requests, from `completion_head` (oldest) to
+  // `completion_tail`, both counting up. The capacity is a power of two,
+  // and the records are cache-line aligned. `completion_data` holds one
+  // word per record.
+  dram_completion_t *completions = nullptr;
+  std::vector<uint8_t> completion_data;
+  uint32_t completion_capacity = 0;
+  uint64_t completion_head = 0;
+  uint64_t completion_tail = 0;
+
+  // One wrapper cycle: 0 or more memory system ticks with a core clock, 1
+  // without.
+  void advance();
+  // Account one memory system tick to the sampler, if any. `at_cycle` is
+  // the wrapper cycle the tick belongs to.
+  void sample(uint64_t at_cycle);
+  DramSampler::Totals sampling_totals(uint64_t at_cycle) const;
+
+  // Number of wrapper cycles since init.
+  uint64_t cycle = 0;
+  // Number of memory system ticks since init.
+  uint64_t memory_cycle = 0;
+  // Clock periods in femtoseconds, `core_period` 0 without a core clock,
+  // and the time the memory clock lags behind the core clock, always less
+  // than `memory_period`. Integers keep the ratio exact over long runs.
+  uint64_t core_period = 0;
+  uint64_t memory_period = 0;
+  uint64_t clock_phase = 0;
+  // Number of completion callbacks fired since init.
+  uint64_t num_completed = 0;
+  // Number of accepted requests whose callback has not fired yet.
+  uint64_t num_outstanding = 0;
 };
 
+// All entry points of the C interface, resolved once through
+// `dram_get_vtable` instead of one symbol lookup per call. Fields are only
+// ever appended, and `struct_size` lets a binding check that the loaded
+// library is at least as new as the layout it was written against.
+struct dram_vtable_t {
+  uint64_t struct_size;
+  CRamualator2Wrapper *(*dram_new)();
+  void (*dram_delete)(CRamualator2Wrapper *obj);
+  void (*dram_init)(CRamualator2Wrapper *obj, const char *config);
+  float (*get_memory_tCK)(CRamualator2Wrapper *obj);
+  bool (*send_request)(CRamualator2Wrapper *obj, int64_t addr, bool is_write,
+                       dram_callback_t callback, void *ctx);
+  void (*finish)(CRamualator2Wrapper *obj);
+  void (*frontend_tick)(CRamualator2Wrapper *obj);
+  void (*memory_system_tick)(CRamualator2Wrapper *obj);
+  uint64_t (*tick_n)(CRamualator2Wrapper *obj, uint64_t n,
+                     bool stop_on_completion);
+  uint64_t (*run_until)(CRamualator2Wrapper *obj, uint64_t cycle,
+                        bool stop_on_completion);
+  uint64_t (*get_cycle)(CRamualator2Wrapper *obj);
+  uint64_t (*next_event_cycle)(CRamualator2Wrapper *obj);
+  uint64_t (*skip_to)(CRamualator2Wrapper *obj, uint64_t cycle);
+  void (*config_store)(CRamualator2Wrapper *obj, uint32_t word_bytes,
+                       uint64_t num_words);
+  bool (*load_hex)(CRamualator2Wrapper *obj, const char *path);
+  bool (*send_write)(CRamualator2Wrapper *obj, int64_t addr,
+                     const uint8_t *data, dram_callback_t callback, void *ctx);
+  void (*read_data)(CRamualator2Wrapper *obj, int64_t addr, uint8_t *out);
+  bool (*load_image)(CRamualator2Wrapper *obj, const char *path,
+                     uint64_t base_addr);
+  uint32_t (*send_requests)(CRamualator2Wrapper *obj, const int64_t *addrs,
+                            const bool *is_write, uint32_t n,
+                            const uint8_t *data, dram_callback_t callback,
+                            void *ctx, uint64_t *accepted);
+  uint64_t (*submit)(CRamualator2Wrapper *obj, int64_t addr, bool is_write,
+                     const uint8_t *data, dram_callback_t callback, void *ctx);
+  uint64_t (*next_request_id)(CRamualator2Wrapper *obj);
+  uint32_t (*poll_completions)(CRamualator2Wrapper *obj,
+                               dram_completion_t *out, uint8_t *data,
+                               uint32_t max);
+  DramGroup *(*group_new)(uint32_t num_threads);
+  void (*group_delete)(DramGroup *group);
+  void (*group_add)(DramGroup *group, CRamualator2Wrapper *obj);
+  void (*group_tick)(DramGroup *group, uint64_t n);
+  void (*set_core_clock)(CRamualator2Wrapper *obj, double core_tck);
+  uint64_t (*get_memory_cycle)(CRamualator2Wrapper *obj);
+  uint32_t (*get_stats)(CRamualator2Wrapper *obj, dram_stats_t *out,
+                        uint32_t size);
+  bool (*dump_latency_csv)(CRamualator2Wrapper *obj, const char *path);
+  void (*set_latency_csv)(CRamualator2Wrapper *obj, const char *path);
+  bool (*start_sampling)(CRamualator2Wrapper *obj, const char *path,
+                         uint64_t interval, bool binary);
+  void (*stop_sampling)(CRamualator2Wrapper *obj);
+  bool (*start_trace)(CRamualator2Wrapper *obj, const char *path);
+  bool (*stop_trace)(CRamualator2Wrapper *obj);
+  bool (*checkpoint)(CRamualator2Wrapper *obj, const char *path);
+  bool (*restore)(CRamualator2Wrapper *obj, const char *path);
+  uint32_t (*get_word_bytes)(CRamualator2Wrapper *obj);
+  void (*set_coalescing)(CRamualator2Wrapper *obj, uint64_t line_size,
+                         uint64_t write_window);
+  CRamualator2Wrapper *(*dram_new_fast)();
+  bool (*set_detailed_windows)(CRamualator2Wrapper *obj, uint64_t period,
+                               uint64_t window, uint64_t warmup);
+  void (*dram_init_mapped)(CRamualator2Wrapper *obj, const char *config,
+                           const char *mapper);
+  uint32_t (*decode_addr)(CRamualator2Wrapper *obj, int64_t addr,
+                          int64_t *out, uint32_t max);
+  const char *(*addr_level_name)(CRamualator2Wrapper *obj, uint32_t level);
+  uint32_t (*peek_completions)(CRamualator2Wrapper *obj,
+                               const dram_completion_t **records,
+                               const uint8_t **data);
+  void (*release_completions)(CRamualator2Wrapper *obj, uint32_t count);
+  uint32_t (*queue_free_slots)(CRamualator2Wrapper *obj);
+  uint32_t (*num_channels)(CRamualator2Wrapper *obj);
+  uint32_t (*channel_occupancy)(CRamualator2Wrapper *obj, uint32_t channel);
+  void (*dram_reset)(CRamualator2Wrapper *obj);
+  void (*set_prefetch_hook)(CRamualator2Wrapper *obj, dram_prefetch_hook_t hook,
+                            void *ctx);
+};
+
+extern "C" const dram_vtable_t *dram_get_vtable();
+
 #endif // CRAMUALATOR2WRAPPER_H
@@ -0,0 +1,32 @@
+#include "./ChannelQueues.h"
+#include <algorithm>
+
+void ChannelQueues::configure(uint32_t channels, uint32_t initial_capacity) {
+    in_flight.assign(channels, 0);
+    capacity.assign(channels, initial_capacity);
+}
+
+void ChannelQueues::on_accept(uint32_t channel, bool learn) {
+    in_flight[channel]++;
+    if (learn) {
+        capacity[channel] = std::max(capacity[channel], in_flight[channel]);
+    }
+}
+
+void ChannelQueues::on_reject(uint32_t channel) {
+    // At least one, so that a rejection with nothing in flight, e.g. at a
+    // refresh, does not close the channel for good.
+    capacity[channel] = std::max(1u, in_flight[channel]);
+}
+
+uint32_t ChannelQueues::free_slots(uint32_t channel) const {
+    return capacity[channel] > in_flight[channel] ? capacity[channel] - in_flight[channel] : 0;
+}
+
+uint32_t ChannelQueues::free_slots() const {
+    uint32_t total = 0;
+    for (uint32_t channel = 0; channel < num_channels(); channel++) {
+        total += free_slots(channel);
+    }
+    return total;
+}
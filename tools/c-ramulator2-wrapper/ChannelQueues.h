@@ -0,0 +1,39 @@
+#ifndef CHANNELQUEUES_H
+#define CHANNELQUEUES_H
+
+#include <cstdint>
+#include <vector>
+
+// The requests in flight in each channel of a memory, and an estimate of how
+// many more each one takes. Ramulator2 exposes neither its controllers'
+// buffers nor their fill, so the capacity of a channel starts at that of
+// Ramulator2's request buffer and follows what the memory does: it drops to
+// the channel's occupancy when a request is rejected, and rises with it when
+// one is accepted past it.
+class ChannelQueues {
+
+public:
+  // The size of `ReqBuffer` in Ramulator2's generic controller.
+  static constexpr uint32_t DEFAULT_CAPACITY = 32;
+
+  // `channels` channels of `initial_capacity` requests each, none in flight.
+  void configure(uint32_t channels, uint32_t initial_capacity);
+  uint32_t num_channels() const { return uint32_t(in_flight.size()); }
+  // A request to `channel` was accepted; with `learn`, by a memory whose
+  // capacity is estimated.
+  void on_accept(uint32_t channel, bool learn);
+  // A request to `channel` was rejected by a memory whose capacity is
+  // estimated: it holds no more than it has in flight.
+  void on_reject(uint32_t channel);
+  void on_complete(uint32_t channel) { in_flight[channel]--; }
+  uint32_t occupancy(uint32_t channel) const { return in_flight[channel]; }
+  // Estimated requests `channel` still takes, and all channels together.
+  uint32_t free_slots(uint32_t channel) const;
+  uint32_t free_slots() const;
+
+private:
+  std::vector<uint32_t> in_flight;
+  std::vector<uint32_t> capacity;
+};
+
+#endif // CHANNELQUEUES_H
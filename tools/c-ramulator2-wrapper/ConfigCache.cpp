@@ -0,0 +1,46 @@
+#include "./ConfigCache.h"
+#include "base/config.h"
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+std::mutex cache_mutex;
+std::unordered_map<std::string, YAML::Node> cache;
+uint64_t parsed = 0;
+
+} // namespace
+
+YAML::Node ConfigCache::load(const std::string& config) {
+    // No file name spans several lines, so such a config is inline YAML.
+    bool is_file = config.find('\n') == std::string::npos;
+    std::string text = config;
+    if (is_file) {
+        std::ifstream file(config, std::ios::binary);
+        if (!file) {
+            // Not cached: Ramulator2 reports the error.
+            return Ramulator::Config::parse_config_file(config, {});
+        }
+        text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    // yaml-cpp nodes share their memory, and are not safe to read from
+    // several threads at a time, so clones are taken under the lock too.
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(text);
+    if (it == cache.end()) {
+        YAML::Node node = is_file ? Ramulator::Config::parse_config_file(config, {}) : YAML::Load(text);
+        if (cache.size() >= MAX_ENTRIES) {
+            cache.clear();
+        }
+        it = cache.emplace(std::move(text), node).first;
+        parsed++;
+    }
+    return YAML::Clone(it->second);
+}
+
+uint64_t ConfigCache::num_parsed() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return parsed;
+}
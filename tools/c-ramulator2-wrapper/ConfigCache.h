@@ -0,0 +1,26 @@
+#ifndef CONFIGCACHE_H
+#define CONFIGCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <yaml-cpp/yaml.h>
+
+// Parsed configurations, shared by every wrapper instance of the process, so
+// that a harness creating many instances of a few configs parses each one
+// once. Entries are keyed by the text of the config, read again on every
+// `load` of a file, so an edited file is parsed anew.
+class ConfigCache {
+
+public:
+  // Configs kept at most; the cache starts over once that many are kept.
+  static constexpr size_t MAX_ENTRIES = 32;
+
+  // The config of `config`, a path or, if it spans several lines, inline
+  // YAML, as `CRamualator2Wrapper::init` takes it. The node is the caller's
+  // own copy, free to be modified. Throws as parsing would.
+  static YAML::Node load(const std::string &config);
+  // Loads parsed, rather than found in the cache, since the process started.
+  static uint64_t num_parsed();
+};
+
+#endif // CONFIGCACHE_H
@@ -0,0 +1,107 @@
+#include "./DetailedWindows.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Two-sided 95% quantiles of Student's t, by degrees of freedom from 1; the
+// normal one beyond.
+const double T_95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                       2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                       2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+} // namespace
+
+void DetailedWindows::Estimate::add(double sample) {
+    n++;
+    double delta = sample - mean;
+    mean += delta / double(n);
+    m2 += delta * (sample - mean);
+}
+
+double DetailedWindows::Estimate::half_width() const {
+    if (n < 2) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    uint64_t df = n - 1;
+    double t = df <= sizeof(T_95) / sizeof(T_95[0]) ? T_95[df - 1] : 1.960;
+    return t * std::sqrt(m2 / double(df) / double(n));
+}
+
+DetailedWindows::DetailedWindows(uint64_t period, uint64_t window, uint64_t warmup, uint32_t word_bytes,
+                                 double tck)
+    : period(period), window(window), warmup(warmup), word_bytes(word_bytes), tck(tck) {
+    kept[0].reserve(MAX_LATENCIES);
+    kept[1].reserve(MAX_LATENCIES);
+}
+
+void DetailedWindows::start_window() {
+    completed = 0;
+    latency_sum = 0;
+    seen[0] = seen[1] = 0;
+    peak = 0;
+    kept[0].clear();
+    kept[1].clear();
+    ended_window = false;
+}
+
+void DetailedWindows::on_complete(bool is_write, uint32_t latency) {
+    if (!measuring()) {
+        return;
+    }
+    if (ended_window) {
+        start_window();
+    }
+    completed++;
+    latency_sum += latency;
+    // Reservoir sampling, so that every latency of the window is as likely
+    // to be kept.
+    std::vector<uint32_t>& sample = kept[is_write];
+    uint64_t n = ++seen[is_write];
+    if (sample.size() < MAX_LATENCIES) {
+        sample.push_back(latency);
+        return;
+    }
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    if (rng % n < MAX_LATENCIES) {
+        sample[rng % n] = latency;
+    }
+}
+
+bool DetailedWindows::tick(uint64_t in_flight) {
+    if (detailed()) {
+        detailed_cycles++;
+    }
+    if (measuring()) {
+        if (ended_window) {
+            start_window();
+        }
+        peak = std::max(peak, in_flight);
+    }
+    phase++;
+    bool ended = phase == warmup + window;
+    if (ended) {
+        bandwidth.add(double(completed * word_bytes) / (double(window) * tck));
+        if (completed) {
+            latency.add(double(latency_sum) / double(completed));
+        }
+        // Kept for the caller until the next window measures its first cycle.
+        ended_window = true;
+    }
+    if (phase == period) {
+        phase = 0;
+    }
+    return ended;
+}
+
+void DetailedWindows::estimate(dram_stats_t& out) const {
+    out.detailed_windows = bandwidth.n;
+    out.detailed_memory_cycles = detailed_cycles;
+    out.est_latency_avg = latency.n ? latency.mean : std::numeric_limits<double>::quiet_NaN();
+    out.est_latency_ci = latency.half_width();
+    out.est_bandwidth = bandwidth.n ? bandwidth.mean : std::numeric_limits<double>::quiet_NaN();
+    out.est_bandwidth_ci = bandwidth.half_width();
+}
@@ -0,0 +1,83 @@
+#ifndef DETAILEDWINDOWS_H
+#define DETAILEDWINDOWS_H
+
+#include "./DramStats.h"
+#include <cstdint>
+#include <vector>
+
+// Sampled simulation, after SMARTS: of every `period` memory cycles, the
+// first `warmup + window` are simulated in detail, by Ramulator2, and the
+// rest by a latency model. The `window` cycles after the warm-up are
+// measured: each window makes one sample of the mean latency and of the
+// bandwidth, from which those of the whole run are estimated, with a
+// confidence interval, and the latencies it measured calibrate the model for
+// the stretch that follows.
+class DetailedWindows {
+
+public:
+  // Latencies kept per window and type to calibrate the model on, drawn
+  // uniformly from those measured.
+  static constexpr size_t MAX_LATENCIES = 4096;
+
+  // `window` must be at least 1, and `warmup + window` less than `period`,
+  // so that the model runs between the windows.
+  // `word_bytes` and `tck`, in ns, turn completions into bandwidth.
+  DetailedWindows(uint64_t period, uint64_t window, uint64_t warmup,
+                  uint32_t word_bytes, double tck);
+
+  // Whether the current memory cycle is simulated in detail.
+  bool detailed() const { return phase < warmup + window; }
+  // Account a request the detailed memory completed in the current cycle.
+  void on_complete(bool is_write, uint32_t latency);
+  // Move on to the next memory cycle, with `in_flight` requests in the
+  // detailed memory. Returns true if that ended a measured window, after
+  // which `latencies` and `peak_in_flight` describe it until the next one.
+  bool tick(uint64_t in_flight);
+  const std::vector<uint32_t> &latencies(bool is_write) const {
+    return kept[is_write];
+  }
+  uint64_t peak_in_flight() const { return peak; }
+  // Fill in the `detailed_*` and `est_*` fields of `out`.
+  void estimate(dram_stats_t &out) const;
+
+private:
+  // Mean and variance of one statistic over the windows, by Welford's
+  // method.
+  struct Estimate {
+    uint64_t n = 0;
+    double mean = 0;
+    double m2 = 0;
+    void add(double sample);
+    // Half-width of the 95% confidence interval of the mean, NaN below two
+    // samples.
+    double half_width() const;
+  };
+
+  bool measuring() const { return phase >= warmup && phase < warmup + window; }
+  // Drop what the last window measured, on the first cycle of the next.
+  void start_window();
+
+  uint64_t period;
+  uint64_t window;
+  uint64_t warmup;
+  uint32_t word_bytes;
+  double tck;
+  // Index of the current memory cycle in its period.
+  uint64_t phase = 0;
+  uint64_t detailed_cycles = 0;
+
+  // The window being measured, or the last one, until the next starts: set
+  // once it ended.
+  bool ended_window = false;
+  uint64_t completed = 0;
+  uint64_t latency_sum = 0;
+  uint64_t seen[2] = {0, 0};
+  uint64_t peak = 0;
+  std::vector<uint32_t> kept[2];
+  uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+  Estimate latency;
+  Estimate bandwidth;
+};
+
+#endif // DETAILEDWINDOWS_H
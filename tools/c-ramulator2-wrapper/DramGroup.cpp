@@ -0,0 +1,112 @@
+#include "./DramGroup.h"
+#include "./CRamualator2Wrapper.h"
+#include <algorithm>
+
+namespace {
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+DramGroup::DramGroup(uint32_t num_threads)
+    : num_threads(num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+DramGroup::~DramGroup() {
+    stop();
+}
+
+void DramGroup::add(CRamualator2Wrapper* member) {
+    // The shares depend on the number of members: workers restart on the
+    // next tick.
+    stop();
+    members.push_back(member);
+}
+
+void DramGroup::start() {
+    uint32_t count = std::min<uint64_t>(num_threads, members.size());
+    stopping = false;
+    for (uint32_t worker = 1; worker < count; worker++) {
+        // The worker waits for the generation after the current one, even
+        // if it only gets scheduled once that tick has been released.
+        workers.emplace_back(&DramGroup::work, this, worker, generation.load());
+    }
+}
+
+void DramGroup::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    workers.clear();
+}
+
+void DramGroup::run_share(uint32_t worker) {
+    // Member `i` belongs to worker `i % (workers + 1)`, the caller being 0.
+    for (size_t i = worker; i < members.size(); i += workers.size() + 1) {
+        members[i]->tick_n(cycles, false);
+    }
+}
+
+void DramGroup::work(uint32_t worker, uint64_t seen) {
+    for (;;) {
+        for (uint32_t spin = 0; spin < SPIN_LIMIT && generation.load(std::memory_order_acquire) == seen; spin++) {
+            cpu_relax();
+        }
+        if (generation.load(std::memory_order_acquire) == seen) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation.load(std::memory_order_acquire) != seen; });
+        }
+        if (generation.load(std::memory_order_acquire) == seen) {
+            return;  // stopping, with no tick left to run
+        }
+        seen++;
+        run_share(worker);
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_one();
+        }
+    }
+}
+
+void DramGroup::tick(uint64_t n) {
+    if (members.empty() || n == 0) {
+        return;
+    }
+    if (workers.empty() && std::min<uint64_t>(num_threads, members.size()) > 1) {
+        start();
+    }
+    if (workers.empty()) {
+        cycles = n;
+        run_share(0);
+        return;
+    }
+
+    cycles = n;
+    pending.store(workers.size(), std::memory_order_relaxed);
+    {
+        // Under the lock, so that a worker about to block sees the new
+        // generation in its predicate.
+        std::lock_guard<std::mutex> lock(mutex);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+    run_share(0);
+
+    for (uint32_t spin = 0; spin < SPIN_LIMIT && pending.load(std::memory_order_acquire); spin++) {
+        cpu_relax();
+    }
+    if (pending.load(std::memory_order_acquire)) {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return pending.load(std::memory_order_acquire) == 0; });
+    }
+}
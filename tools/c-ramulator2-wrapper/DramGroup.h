@@ -0,0 +1,61 @@
+#ifndef DRAMGROUP_H
+#define DRAMGROUP_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CRamualator2Wrapper;
+
+// Ticks a set of independent wrapper instances in parallel.
+//
+// Members share nothing, so each thread ticks its own share of them, and
+// `tick` returns once every member has advanced: a barrier between the
+// memories and the caller. The calling thread ticks a share itself, so a
+// group of `n` threads spawns `n - 1` workers, at most one per member.
+class DramGroup {
+
+public:
+  // `num_threads` counts the caller; 0 picks the hardware concurrency.
+  explicit DramGroup(uint32_t num_threads);
+  ~DramGroup();
+  DramGroup(const DramGroup &) = delete;
+  DramGroup &operator=(const DramGroup &) = delete;
+
+  // Members must outlive the group, or at least its last `tick`.
+  void add(CRamualator2Wrapper *member);
+  // Tick every member `n` times. Completion callbacks of the members, if
+  // any, run on worker threads; polled completions stay queued in each
+  // member until the caller drains them.
+  void tick(uint64_t n);
+
+private:
+  // Workers spin this many times for the next tick before they block, so
+  // back-to-back single-cycle ticks do not pay for a wake-up each.
+  static constexpr uint32_t SPIN_LIMIT = 256;
+
+  void start();
+  void stop();
+  // Each worker runs its share once per generation after `seen`.
+  void work(uint32_t worker, uint64_t seen);
+  void run_share(uint32_t worker);
+
+  uint32_t num_threads;
+  std::vector<CRamualator2Wrapper *> members;
+  std::vector<std::thread> workers;
+
+  // Bumped by `tick` to release the workers, which then count `pending`
+  // down as they finish their share.
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::atomic<uint64_t> generation{0};
+  std::atomic<uint32_t> pending{0};
+  uint64_t cycles = 0;
+  bool stopping = false;
+};
+
+#endif // DRAMGROUP_H
@@ -0,0 +1,84 @@
+#include "./DramSampler.h"
+#include <chrono>
+#include <cinttypes>
+
+DramSampler::DramSampler(std::FILE* file, uint64_t interval, uint32_t word_bytes, bool binary, const Totals& start)
+    : file(file), interval(interval ? interval : 1), word_bytes(word_bytes), binary(binary), last(start),
+      ring(new dram_sample_t[RING_CAPACITY]) {
+    if (!binary) {
+        std::fputs("memory_cycle,cycle,bytes_read,bytes_written,reads_completed,writes_completed,"
+                   "rejected,outstanding,occupancy_sum,latency_sum\n", file);
+    }
+    writer = std::thread(&DramSampler::write_out, this);
+}
+
+DramSampler::~DramSampler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    std::fclose(file);
+}
+
+void DramSampler::record(const Totals& now) {
+    uint64_t k = tail.load(std::memory_order_relaxed);
+    if (k - head.load(std::memory_order_acquire) == RING_CAPACITY) {
+        num_dropped++;
+    } else {
+        dram_sample_t& sample = ring[k % RING_CAPACITY];
+        sample.memory_cycle = now.memory_cycle;
+        sample.cycle = now.cycle;
+        sample.reads_completed = uint32_t(now.reads_completed - last.reads_completed);
+        sample.writes_completed = uint32_t(now.writes_completed - last.writes_completed);
+        sample.bytes_read = uint64_t(sample.reads_completed) * word_bytes;
+        sample.bytes_written = uint64_t(sample.writes_completed) * word_bytes;
+        sample.rejected = uint32_t(now.rejected - last.rejected);
+        sample.outstanding = uint32_t(now.outstanding);
+        sample.occupancy_sum = occupancy_sum;
+        sample.latency_sum = now.latency_sum - last.latency_sum;
+        tail.store(k + 1, std::memory_order_release);
+        if (k + 1 - head.load(std::memory_order_relaxed) == RING_CAPACITY / 2) {
+            // Without the lock: at worst the writer wakes on its timeout.
+            wake.notify_one();
+        }
+    }
+    last = now;
+    window_cycles = 0;
+    occupancy_sum = 0;
+}
+
+void DramSampler::write_out() {
+    for (;;) {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(10), [&] { return stopping; });
+            stop = stopping;
+        }
+        uint64_t k = head.load(std::memory_order_relaxed);
+        uint64_t end = tail.load(std::memory_order_acquire);
+        for (; k != end; k++) {
+            write(ring[k % RING_CAPACITY]);
+        }
+        // Hand the records back only once they are written.
+        head.store(end, std::memory_order_release);
+        if (stop) {
+            std::fflush(file);
+            return;
+        }
+    }
+}
+
+void DramSampler::write(const dram_sample_t& sample) {
+    if (binary) {
+        std::fwrite(&sample, sizeof(sample), 1, file);
+        return;
+    }
+    std::fprintf(file, "%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32
+                 ",%" PRIu32 ",%" PRIu64 ",%" PRIu64 "\n",
+                 sample.memory_cycle, sample.cycle, sample.bytes_read, sample.bytes_written,
+                 sample.reads_completed, sample.writes_completed, sample.rejected, sample.outstanding,
+                 sample.occupancy_sum, sample.latency_sum);
+}
@@ -0,0 +1,104 @@
+#ifndef DRAMSAMPLER_H
+#define DRAMSAMPLER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// One window of a time series taken by `DramSampler`. Counts cover the
+// window only; `cycle`, `memory_cycle` and `outstanding` are taken at its
+// end. Two records fill a cache line, and the binary format is an array of
+// them.
+struct dram_sample_t {
+  uint64_t memory_cycle;
+  uint64_t cycle;
+  uint64_t bytes_read;
+  uint64_t bytes_written;
+  uint32_t reads_completed;
+  uint32_t writes_completed;
+  uint32_t rejected;
+  uint32_t outstanding;
+  // Requests in flight, summed over the memory cycles of the window: divided
+  // by their number, the mean occupancy of the memory.
+  uint64_t occupancy_sum;
+  // Memory cycles, summed over the requests completed in the window.
+  uint64_t latency_sum;
+};
+static_assert(sizeof(dram_sample_t) == 64, "bindings mirror this layout");
+
+// Records a `dram_sample_t` every `interval` memory cycles into a ring, which
+// a background thread writes out, so that the ticking thread never waits
+// for the file.
+//
+// The ticking thread is the only producer and the writer thread the only
+// consumer. If the writer falls a whole ring behind, samples are dropped
+// rather than stalling the tick, and counted.
+class DramSampler {
+
+public:
+  // Cumulative counters of the memory, as of the end of a window.
+  struct Totals {
+    uint64_t cycle;
+    uint64_t memory_cycle;
+    uint64_t reads_completed;
+    uint64_t writes_completed;
+    uint64_t rejected;
+    uint64_t latency_sum;
+    uint64_t outstanding;
+  };
+
+  // Samples go to `file`, as CSV under a header, or as raw records if
+  // `binary` is set. The sampler owns, and eventually closes, the file.
+  DramSampler(std::FILE *file, uint64_t interval, uint32_t word_bytes,
+              bool binary, const Totals &start);
+  // Writes out the samples left in the ring.
+  ~DramSampler();
+  DramSampler(const DramSampler &) = delete;
+  DramSampler &operator=(const DramSampler &) = delete;
+
+  // Account one memory cycle with `outstanding` requests in flight. Returns
+  // true when the window is over, and `record` is due.
+  bool tick(uint64_t outstanding) {
+    occupancy_sum += outstanding;
+    return ++window_cycles == interval;
+  }
+  void record(const Totals &now);
+  // Whether memory cycles were accounted since the last `record`.
+  bool mid_window() const { return window_cycles != 0; }
+
+  uint64_t dropped() const { return num_dropped; }
+
+private:
+  static constexpr uint32_t RING_CAPACITY = 4096;
+
+  void write_out();
+  void write(const dram_sample_t &sample);
+
+  std::FILE *file;
+  uint64_t interval;
+  uint32_t word_bytes;
+  bool binary;
+
+  // Producer state: the totals at the start of the window.
+  Totals last;
+  uint64_t window_cycles = 0;
+  uint64_t occupancy_sum = 0;
+  uint64_t num_dropped = 0;
+
+  // Records from `head` (oldest) to `tail`, both counting up.
+  std::unique_ptr<dram_sample_t[]> ring;
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  std::thread writer;
+};
+
+#endif // DRAMSAMPLER_H
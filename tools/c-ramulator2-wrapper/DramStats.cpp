@@ -0,0 +1,69 @@
+#include "./DramStats.h"
+#include <fstream>
+
+void DramStats::on_submit(bool is_write, bool accepted) {
+    if (!accepted) {
+        rejected++;
+    } else if (is_write) {
+        writes++;
+    } else {
+        reads++;
+    }
+}
+
+void DramStats::on_complete(bool is_write, uint64_t latency) {
+    (is_write ? write_latency : read_latency).record(latency);
+}
+
+void DramStats::on_coalesce(bool is_write) {
+    (is_write ? coalesced_writes : coalesced_reads)++;
+}
+
+void DramStats::on_row_switch() {
+    row_switches++;
+}
+
+void DramStats::snapshot(dram_stats_t& out) const {
+    LatencyHistogram all = read_latency;
+    all += write_latency;
+    out.reads = reads;
+    out.writes = writes;
+    out.rejected = rejected;
+    out.coalesced_reads = coalesced_reads;
+    out.coalesced_writes = coalesced_writes;
+    out.row_switches = row_switches;
+    out.prefetches = prefetches;
+    out.prefetches_dropped = prefetches_dropped;
+    out.prefetches_useful = prefetches_useful;
+    out.prefetches_late = prefetches_late;
+    out.prefetches_useless = prefetches_useless;
+    out.reads_completed = read_latency.count();
+    out.writes_completed = write_latency.count();
+    out.latency_sum = all.sum();
+    out.latency_min = all.min();
+    out.latency_max = all.max();
+    out.latency_p50 = all.percentile(500000);
+    out.latency_p95 = all.percentile(950000);
+    out.latency_p99 = all.percentile(990000);
+    out.latency_p999 = all.percentile(999000);
+    out.latency_avg = all.mean();
+    out.read_latency_p50 = read_latency.percentile(500000);
+    out.read_latency_p99 = read_latency.percentile(990000);
+    out.read_latency_p999 = read_latency.percentile(999000);
+    out.read_latency_max = read_latency.max();
+    out.write_latency_p50 = write_latency.percentile(500000);
+    out.write_latency_p99 = write_latency.percentile(990000);
+    out.write_latency_p999 = write_latency.percentile(999000);
+    out.write_latency_max = write_latency.max();
+}
+
+bool DramStats::dump_csv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "type,low,high,count\n";
+    read_latency.write_csv(out, "read");
+    write_latency.write_csv(out, "write");
+    return bool(out);
+}
@@ -0,0 +1,125 @@
+#ifndef DRAMSTATS_H
+#define DRAMSTATS_H
+
+#include "./LatencyHistogram.h"
+#include <cstdint>
+#include <string>
+
+// A snapshot of the counters of one wrapper instance, as filled in by
+// `dram_get_stats`. Latencies are in memory cycles, from arrival to
+// departure, and only cover completed requests. Fields are only ever
+// appended, and `struct_size` tells how many the library filled in.
+struct dram_stats_t {
+  uint64_t struct_size;
+  // Value of `get_cycle` and `get_memory_cycle`.
+  uint64_t cycle;
+  uint64_t memory_cycle;
+  // Requests accepted by the frontend, by type, and requests rejected.
+  uint64_t reads;
+  uint64_t writes;
+  uint64_t rejected;
+  uint64_t reads_completed;
+  uint64_t writes_completed;
+  // Accepted requests not completed yet.
+  uint64_t outstanding;
+  // One word of the backing store per completed request.
+  uint64_t bytes_read;
+  uint64_t bytes_written;
+  uint64_t latency_sum;
+  uint64_t latency_min;
+  uint64_t latency_max;
+  uint64_t latency_p50;
+  uint64_t latency_p95;
+  uint64_t latency_p99;
+  double latency_avg;
+  // Bytes completed per nanosecond of memory time, i.e. GB/s.
+  double bandwidth;
+  uint64_t latency_p999;
+  // The same, by type.
+  uint64_t read_latency_p50;
+  uint64_t read_latency_p99;
+  uint64_t read_latency_p999;
+  uint64_t read_latency_max;
+  uint64_t write_latency_p50;
+  uint64_t write_latency_p99;
+  uint64_t write_latency_p999;
+  uint64_t write_latency_max;
+  // Accepted requests merged into a transaction to the same line already in
+  // flight, instead of being sent to the memory system. Also counted in
+  // `reads` and `writes`.
+  uint64_t coalesced_reads;
+  uint64_t coalesced_writes;
+  // Sampled simulation, see `set_detailed_windows`, all 0 without: measured
+  // windows so far and memory cycles simulated in detail, then the run's
+  // mean latency and bandwidth estimated from the windows, with the
+  // half-widths of their 95% confidence intervals, NaN until two windows.
+  uint64_t detailed_windows;
+  uint64_t detailed_memory_cycles;
+  double est_latency_avg;
+  double est_latency_ci;
+  double est_bandwidth;
+  double est_bandwidth_ci;
+  // Transactions sent to a bank whose last transaction was to another row,
+  // by the wrapper's `AddressMapper`, in the order they were sent; 0 if the
+  // config's mapper is not modeled.
+  uint64_t row_switches;
+  // Prefetching, see `Prefetcher`: lines read ahead and refused by the
+  // memory, then how prefetched lines fared: found by a demand read once
+  // arrived, found on their way, or evicted or written to before any demand
+  // read found them. Demand reads served from a line are also
+  // counted in `reads`, with their own latencies.
+  uint64_t prefetches;
+  uint64_t prefetches_dropped;
+  uint64_t prefetches_useful;
+  uint64_t prefetches_late;
+  uint64_t prefetches_useless;
+};
+
+// Counters of one wrapper instance, with a latency histogram per request
+// type. Updating them is a few increments per request; percentiles are
+// only worked out by `snapshot`.
+class DramStats {
+
+public:
+  void on_submit(bool is_write, bool accepted);
+  void on_complete(bool is_write, uint64_t latency);
+  // An accepted request that joined another one in flight.
+  void on_coalesce(bool is_write);
+  // A transaction to another row than the last one of its bank.
+  void on_row_switch();
+  // A prefetch sent, or refused by the memory, and the outcome of a line.
+  void on_prefetch() { prefetches++; }
+  void on_prefetch_drop() { prefetches_dropped++; }
+  void on_prefetch_hit(bool late) { (late ? prefetches_late : prefetches_useful)++; }
+  void on_prefetch_useless() { prefetches_useless++; }
+
+  // Fill in the request and latency fields of `out`, leaving the clock,
+  // byte and outstanding fields, which the wrapper knows, alone.
+  void snapshot(dram_stats_t &out) const;
+  // Write both histograms to `path` as CSV, under a
+  // `type,low,high,count` header. Returns false if it cannot be opened.
+  bool dump_csv(const std::string &path) const;
+
+  // Cumulative counts, cheap enough to read every cycle.
+  uint64_t reads_completed() const { return read_latency.count(); }
+  uint64_t writes_completed() const { return write_latency.count(); }
+  uint64_t rejections() const { return rejected; }
+  uint64_t latency_sum() const { return read_latency.sum() + write_latency.sum(); }
+
+private:
+  uint64_t reads = 0;
+  uint64_t writes = 0;
+  uint64_t rejected = 0;
+  uint64_t coalesced_reads = 0;
+  uint64_t coalesced_writes = 0;
+  uint64_t row_switches = 0;
+  uint64_t prefetches = 0;
+  uint64_t prefetches_dropped = 0;
+  uint64_t prefetches_useful = 0;
+  uint64_t prefetches_late = 0;
+  uint64_t prefetches_useless = 0;
+  LatencyHistogram read_latency;
+  LatencyHistogram write_latency;
+};
+
+#endif // DRAMSTATS_H
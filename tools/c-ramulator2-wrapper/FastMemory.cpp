@@ -0,0 +1,127 @@
+#include "./FastMemory.h"
+#include <algorithm>
+
+FastMemory::FastMemory(const YAML::Node& config) {
+    // DDR4-2400: nRCD + nCL + nBL = 16 + 16 + 4 cycles of 0.833 ns.
+    tCK = config["tCK"].as<float>(0.833f);
+    read_latency = std::max(1u, config["read_latency"].as<uint32_t>(36));
+    write_latency = std::max(1u, config["write_latency"].as<uint32_t>(read_latency));
+    row_hit_latency = std::max(1u, config["row_hit_latency"].as<uint32_t>(20));
+    row_size = config["row_size"].as<uint64_t>(0);
+    banks = std::max(1u, config["banks"].as<uint32_t>(16));
+    queue_size = config["queue_size"].as<uint64_t>(0);
+    requests_per_cycle = config["requests_per_cycle"].as<uint32_t>(0);
+
+    if (row_size) {
+        open_rows.assign(banks, -1);
+    }
+    wheel.resize(1);
+    grow(std::max({read_latency, write_latency, row_size ? row_hit_latency : 0u}));
+}
+
+void FastMemory::grow(uint64_t latency) {
+    uint64_t buckets = wheel.size();
+    while (buckets <= latency) {
+        buckets *= 2;
+    }
+    if (buckets == wheel.size()) {
+        return;
+    }
+    std::vector<std::vector<Pending>> grown(buckets);
+    for (std::vector<Pending>& bucket : wheel) {
+        for (Pending& pending : bucket) {
+            grown[pending.due & (buckets - 1)].push_back(std::move(pending));
+        }
+    }
+    wheel.swap(grown);
+    wheel_mask = buckets - 1;
+}
+
+uint64_t FastMemory::free_slots() const {
+    uint64_t free = UINT64_MAX;
+    if (queue_size) {
+        free = queue_size > in_flight ? queue_size - in_flight : 0;
+    }
+    if (requests_per_cycle) {
+        free = std::min<uint64_t>(free, requests_per_cycle - std::min(requests_per_cycle, sent_this_cycle));
+    }
+    return free;
+}
+
+uint64_t FastMemory::cycles_to_next() const {
+    if (!in_flight) {
+        return UINT64_MAX;
+    }
+    // Every request is due within one turn of the wheel, in the first
+    // bucket that is not empty.
+    for (uint64_t i = 1; i <= wheel_mask; i++) {
+        if (!wheel[(clk + i) & wheel_mask].empty()) {
+            return i;
+        }
+    }
+    return UINT64_MAX;
+}
+
+void FastMemory::calibrate(const std::vector<uint32_t>& reads, const std::vector<uint32_t>& writes,
+                           uint64_t queue_size) {
+    this->queue_size = queue_size;
+    const std::vector<uint32_t>* tables[2] = {&reads, &writes};
+    for (int is_write = 0; is_write < 2; is_write++) {
+        if (tables[is_write]->empty()) {
+            continue;
+        }
+        calibrated[is_write] = *tables[is_write];
+        for (uint32_t& latency : calibrated[is_write]) {
+            latency = std::max(1u, latency);
+        }
+        grow(*std::max_element(calibrated[is_write].begin(), calibrated[is_write].end()));
+    }
+}
+
+uint32_t FastMemory::latency_of(int64_t addr, bool is_write) {
+    const std::vector<uint32_t>& table = calibrated[is_write];
+    if (!table.empty()) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        return table[rng % table.size()];
+    }
+    uint32_t latency = is_write ? write_latency : read_latency;
+    if (row_size) {
+        uint64_t row = uint64_t(addr) / row_size;
+        int64_t& open = open_rows[row % banks];
+        if (open == int64_t(row / banks)) {
+            latency = row_hit_latency;
+        }
+        open = int64_t(row / banks);
+    }
+    return latency;
+}
+
+bool FastMemory::send(int64_t addr, bool is_write, std::function<void(Ramulator::Request&)> callback) {
+    if ((queue_size && in_flight >= queue_size) || (requests_per_cycle && sent_this_cycle >= requests_per_cycle)) {
+        return false;
+    }
+    Ramulator::Request req(addr, is_write ? Ramulator::Request::Type::Write : Ramulator::Request::Type::Read, 0,
+                           std::move(callback));
+    req.arrive = int64_t(clk);
+    uint64_t due = clk + latency_of(addr, is_write);
+    wheel[due & wheel_mask].push_back(Pending{due, std::move(req)});
+    in_flight++;
+    sent_this_cycle++;
+    return true;
+}
+
+void FastMemory::tick() {
+    clk++;
+    sent_this_cycle = 0;
+    // Callbacks may send new requests, which land in later buckets, or even
+    // grow the wheel, so the bucket is swapped out first.
+    completing.swap(wheel[clk & wheel_mask]);
+    for (Pending& pending : completing) {
+        pending.req.depart = int64_t(clk);
+        in_flight--;
+        pending.req.callback(pending.req);
+    }
+    completing.clear();
+}
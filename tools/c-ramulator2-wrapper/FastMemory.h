@@ -0,0 +1,89 @@
+#ifndef FASTMEMORY_H
+#define FASTMEMORY_H
+
+#include "base/base.h"
+#include "base/request.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+// A functional stand-in for Ramulator2's frontend and memory system, for runs
+// that need the data of a memory but not its timing: every request completes
+// a fixed number of memory cycles after it arrives, with no controller,
+// scheduler or refresh behind it.
+//
+// The latency is that of a read or a write, unless `row_size` is set: then
+// addresses fall into rows of `row_size` addresses, interleaved over `banks`
+// banks, and a request to the row last opened in its bank takes
+// `row_hit_latency` instead. `queue_size` and `requests_per_cycle`, 0 for no
+// limit, bound the requests in flight and those accepted per memory cycle.
+class FastMemory {
+
+public:
+  // Takes its parameters from `config`, the `FastMemory` section of a wrapper
+  // config, which may be undefined: the defaults approximate a closed-row
+  // read of DDR4-2400, as in the example config.
+  explicit FastMemory(const YAML::Node &config);
+  FastMemory(const FastMemory &) = delete;
+  FastMemory &operator=(const FastMemory &) = delete;
+
+  float get_tCK() const { return tCK; }
+  // Returns false if the memory cannot take the request this cycle.
+  bool send(int64_t addr, bool is_write,
+            std::function<void(Ramulator::Request &)> callback);
+  // One memory cycle: completes the requests due in it, in the order they
+  // were sent.
+  void tick();
+  // Requests `send` takes before refusing one this cycle, UINT64_MAX without
+  // limits.
+  uint64_t free_slots() const;
+  // Memory cycles until the next request completes, UINT64_MAX if none is in
+  // flight.
+  uint64_t cycles_to_next() const;
+  // Draw the latency of each later read from `reads`, and of each write from
+  // `writes`, at random, in place of the configured latencies and row model,
+  // and take at most `queue_size` requests in flight, 0 for no limit. An
+  // empty table leaves the latencies of its type as they were. Used as the
+  // model of sampled simulation, see `DetailedWindows`.
+  void calibrate(const std::vector<uint32_t> &reads,
+                 const std::vector<uint32_t> &writes, uint64_t queue_size);
+
+private:
+  struct Pending {
+    uint64_t due;
+    Ramulator::Request req;
+  };
+
+  uint32_t latency_of(int64_t addr, bool is_write);
+  // Rehash the wheel into enough buckets for `latency`.
+  void grow(uint64_t latency);
+
+  float tCK;
+  uint32_t read_latency;
+  uint32_t write_latency;
+  uint32_t row_hit_latency;
+  uint64_t row_size;
+  uint32_t banks;
+  uint64_t queue_size;
+  uint32_t requests_per_cycle;
+
+  // Row last opened in each bank, -1 if none.
+  std::vector<int64_t> open_rows;
+  // Latencies drawn from by `calibrate`d types.
+  std::vector<uint32_t> calibrated[2];
+  uint64_t rng = 0x2545F4914F6CDD1Dull;
+  // A timing wheel: the requests departing at cycle `c` wait in
+  // `wheel[c & wheel_mask]`. It has more buckets than the longest latency,
+  // growing if need be, so a request never lands in the bucket being
+  // completed, and the buckets keep their capacity, so a steady run does not
+  // allocate. `completing` holds the bucket of the current tick.
+  std::vector<std::vector<Pending>> wheel;
+  std::vector<Pending> completing;
+  uint64_t wheel_mask = 0;
+  uint64_t clk = 0;
+  uint64_t in_flight = 0;
+  uint32_t sent_this_cycle = 0;
+};
+
+#endif // FASTMEMORY_H
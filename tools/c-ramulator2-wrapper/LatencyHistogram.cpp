@@ -0,0 +1,69 @@
+#include "./LatencyHistogram.h"
+#include <algorithm>
+
+uint32_t LatencyHistogram::bucket_of(uint64_t latency) {
+    latency = std::min<uint64_t>(latency, UINT32_MAX);
+    if (latency < SUB_BUCKETS) {
+        return uint32_t(latency);
+    }
+    // Dropping `shift` bits leaves a value in [SUB_BUCKETS, 2 * SUB_BUCKETS).
+    uint32_t shift = 63 - __builtin_clzll(latency) - SUB_BUCKET_BITS;
+    return shift * SUB_BUCKETS + uint32_t(latency >> shift);
+}
+
+uint64_t LatencyHistogram::bucket_low(uint32_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
+    }
+    uint32_t shift = bucket / SUB_BUCKETS - 1;
+    return uint64_t(bucket - shift * SUB_BUCKETS) << shift;
+}
+
+uint64_t LatencyHistogram::bucket_high(uint32_t bucket) {
+    uint32_t shift = bucket < 2 * SUB_BUCKETS ? 0 : bucket / SUB_BUCKETS - 1;
+    return bucket_low(bucket) + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t latency) {
+    counts[bucket_of(latency)]++;
+    total++;
+    latency_sum += latency;
+    latency_min = std::min(latency_min, latency);
+    latency_max = std::max(latency_max, latency);
+}
+
+LatencyHistogram& LatencyHistogram::operator+=(const LatencyHistogram& other) {
+    for (uint32_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        counts[bucket] += other.counts[bucket];
+    }
+    total += other.total;
+    latency_sum += other.latency_sum;
+    latency_min = std::min(latency_min, other.latency_min);
+    latency_max = std::max(latency_max, other.latency_max);
+    return *this;
+}
+
+uint64_t LatencyHistogram::percentile(uint64_t ppm) const {
+    if (!total) {
+        return 0;
+    }
+    // Rank of the percentile among the recorded latencies, counting from 1.
+    uint64_t rank = std::max<uint64_t>(1, (total * ppm + 999999) / 1000000);
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return std::min(bucket_high(bucket), latency_max);
+        }
+    }
+    return latency_max;
+}
+
+void LatencyHistogram::write_csv(std::ostream& out, const char* type) const {
+    for (uint32_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        if (counts[bucket]) {
+            out << type << ',' << bucket_low(bucket) << ',' << bucket_high(bucket) << ','
+                << counts[bucket] << '\n';
+        }
+    }
+}
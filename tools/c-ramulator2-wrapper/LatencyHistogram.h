@@ -0,0 +1,52 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+// A log-linear histogram of latencies, in the style of HdrHistogram.
+//
+// Latencies below `2 * SUB_BUCKETS` get a bucket each. Above that, every
+// power of two is split into `SUB_BUCKETS` buckets of equal width, so a
+// bucket is never wider than 1 / SUB_BUCKETS of the values it holds.
+// Recording a latency is a bit scan, a shift and an increment.
+class LatencyHistogram {
+
+public:
+  static constexpr uint32_t SUB_BUCKET_BITS = 7;
+  static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+  // Latencies are clamped to 32 bits, the width of
+  // `dram_completion_t::latency`.
+  static constexpr uint32_t NUM_BUCKETS = (33 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+  void record(uint64_t latency);
+  LatencyHistogram &operator+=(const LatencyHistogram &other);
+
+  uint64_t count() const { return total; }
+  uint64_t sum() const { return latency_sum; }
+  // Both 0 while empty.
+  uint64_t min() const { return total ? latency_min : 0; }
+  uint64_t max() const { return latency_max; }
+  double mean() const { return total ? double(latency_sum) / double(total) : 0.0; }
+  // Highest latency of the bucket holding the `ppm` millionth of the
+  // recorded latencies, or `max()` if that is lower. 0 while empty.
+  uint64_t percentile(uint64_t ppm) const;
+
+  // One `<type>,<low>,<high>,<count>` line per non-empty bucket, lowest
+  // first. `low` and `high` are the latencies the bucket holds, inclusive.
+  void write_csv(std::ostream &out, const char *type) const;
+
+private:
+  static uint32_t bucket_of(uint64_t latency);
+  static uint64_t bucket_low(uint32_t bucket);
+  static uint64_t bucket_high(uint32_t bucket);
+
+  std::array<uint64_t, NUM_BUCKETS> counts{};
+  uint64_t total = 0;
+  uint64_t latency_sum = 0;
+  uint64_t latency_min = UINT64_MAX;
+  uint64_t latency_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,115 @@
+#include "./Prefetcher.h"
+#include <algorithm>
+
+void Prefetcher::configure(const YAML::Node& config) {
+    std::string impl = config["impl"].as<std::string>("");
+    if (impl == "NextLine") {
+        policy = Policy::NextLine;
+    } else if (impl == "Stride") {
+        policy = Policy::Stride;
+    } else {
+        policy = Policy::Off;
+    }
+    line_size = std::max<uint64_t>(1, config["line_size"].as<uint64_t>(64));
+    degree = std::clamp(config["degree"].as<uint32_t>(2), 1u, MAX_DEGREE);
+    distance = std::max(1u, config["distance"].as<uint32_t>(1));
+    hit_latency = std::max(1u, config["hit_latency"].as<uint32_t>(1));
+    region_size = std::max<uint64_t>(1, config["region_size"].as<uint64_t>(4096));
+    min_confidence = config["confidence"].as<uint32_t>(2);
+
+    // A power of two, for the hash to index.
+    uint64_t buffer = std::max<uint64_t>(2, config["buffer"].as<uint64_t>(64));
+    uint32_t bits = 1;
+    while ((uint64_t(1) << bits) < buffer) {
+        bits++;
+    }
+    lines.assign(size_t(1) << bits, Line{0, 0, 0, false, false});
+    line_shift = 64 - bits;
+    streams.assign(std::max(1u, config["streams"].as<uint32_t>(16)), Stream{0, 0, 0, 0, false});
+}
+
+void Prefetcher::set_hook(dram_prefetch_hook_t hook, void* ctx) {
+    this->hook = hook;
+    hook_ctx = ctx;
+    if (lines.empty()) {
+        // Not configured: the defaults, with the hook alone.
+        configure(YAML::Node());
+    }
+}
+
+Prefetcher::Line* Prefetcher::find(uint64_t line) {
+    if (lines.empty()) {
+        return nullptr;
+    }
+    Line& buffered = entry(line);
+    return buffered.valid && buffered.line == line ? &buffered : nullptr;
+}
+
+uint32_t Prefetcher::train(int64_t addr, int64_t* out) {
+    if (hook) {
+        return std::min(hook(addr, out, degree, hook_ctx), degree);
+    }
+    int64_t step = int64_t(line_size);
+    if (policy == Policy::Stride) {
+        uint64_t region = uint64_t(addr) / region_size;
+        Stream& stream = streams[region % streams.size()];
+        if (!stream.valid || stream.region != region) {
+            stream = Stream{region, addr, 0, 0, true};
+            return 0;
+        }
+        int64_t stride = addr - stream.last_addr;
+        if (stride == 0) {
+            // Another word of the same address: nothing new to learn.
+            return 0;
+        }
+        if (stride == stream.stride) {
+            stream.confidence = std::min(stream.confidence + 1, min_confidence);
+        } else {
+            stream.stride = stride;
+            stream.confidence = 0;
+        }
+        stream.last_addr = addr;
+        if (stream.confidence < min_confidence) {
+            return 0;
+        }
+        step = stride;
+    }
+    // Strides shorter than a line still prefetch ahead by lines.
+    if (step > 0 && step < int64_t(line_size)) {
+        step = int64_t(line_size);
+    } else if (step < 0 && -step < int64_t(line_size)) {
+        step = -int64_t(line_size);
+    }
+    for (uint32_t i = 0; i < degree; i++) {
+        out[i] = addr + step * int64_t(distance + i);
+    }
+    return degree;
+}
+
+bool Prefetcher::insert(uint64_t line, uint32_t slot, uint64_t memory_cycle) {
+    Line& buffered = entry(line);
+    bool useless = buffered.valid && !buffered.used;
+    buffered = Line{line, memory_cycle, slot, true, false};
+    return useless;
+}
+
+void Prefetcher::arrive(uint64_t line, uint32_t slot) {
+    Line* buffered = find(line);
+    if (buffered && buffered->slot == slot) {
+        buffered->slot = ARRIVED;
+    }
+}
+
+bool Prefetcher::invalidate(uint64_t line) {
+    Line* buffered = find(line);
+    if (!buffered) {
+        return false;
+    }
+    buffered->valid = false;
+    return !buffered->used;
+}
+
+void Prefetcher::clear() {
+    std::fill(lines.begin(), lines.end(), Line{0, 0, 0, false, false});
+    std::fill(streams.begin(), streams.end(), Stream{0, 0, 0, 0, false});
+}
@@ -0,0 +1,102 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstdint>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+// Prefetch hook of the C interface, called on every demand read with its
+// address: writes at most `max` addresses to prefetch to `out`, and returns
+// how many it wrote. It must not call into the wrapper.
+typedef uint32_t (*dram_prefetch_hook_t)(int64_t addr, int64_t *out,
+                                         uint32_t max, void *ctx);
+
+// The prefetch stage of a wrapper: which lines to read ahead of the demand
+// reads it sees, and a buffer of the lines read so far. Requests carry no
+// program counter, so strides are learned per region of the address space.
+// The wrapper sends the transactions, and serves the demand reads that find
+// their line here; this only decides and keeps track.
+class Prefetcher {
+
+public:
+  // The most lines one demand read may trigger.
+  static constexpr uint32_t MAX_DEGREE = 16;
+  // `Line::slot` once the line's transaction has completed.
+  static constexpr uint32_t ARRIVED = UINT32_MAX;
+
+  // A buffered line: prefetched by the transaction of `slot`, a slot of
+  // the wrapper, sent at `memory_cycle`, until it arrives. `used` once a
+  // demand read found it.
+  struct Line {
+    uint64_t line;
+    uint64_t memory_cycle;
+    uint32_t slot;
+    bool valid;
+    bool used;
+  };
+
+  enum class Policy { Off, NextLine, Stride };
+
+  // Take the policy and its parameters from `config`, the `Prefetcher`
+  // section of a wrapper config, which may be undefined: off. Drops every
+  // line and what was learned.
+  void configure(const YAML::Node &config);
+  // Ask `hook` for the addresses to prefetch in place of the policy, or,
+  // with a null `hook`, go back to it.
+  void set_hook(dram_prefetch_hook_t hook, void *ctx);
+  bool enabled() const { return policy != Policy::Off || hook; }
+  uint64_t line_of(int64_t addr) const { return uint64_t(addr) / line_size; }
+  int64_t line_addr(uint64_t line) const { return int64_t(line * line_size); }
+  // Memory cycles to serve a demand read from a line that arrived.
+  uint32_t get_hit_latency() const { return hit_latency; }
+
+  // The buffered line `line`, or null.
+  Line *find(uint64_t line);
+  // Learn from a demand read of `addr`, and write the addresses to prefetch
+  // after it, at most `MAX_DEGREE`, to `out`. Returns how many.
+  uint32_t train(int64_t addr, int64_t *out);
+  // Buffer `line`, whose prefetch the transaction of `slot` just sent.
+  // Returns true if it evicted a line that was never used.
+  bool insert(uint64_t line, uint32_t slot, uint64_t memory_cycle);
+  // The transaction of `slot` for `line` completed. The line may have left
+  // the buffer meanwhile.
+  void arrive(uint64_t line, uint32_t slot);
+  // A write to `line` was accepted: drop it, so that reads after the write
+  // are not served ahead of it. Returns true if the line was never used.
+  bool invalidate(uint64_t line);
+  // Drop every line and what was learned, keeping the configuration.
+  void clear();
+
+private:
+  // One region of `region_size` addresses: the last address read in it, the
+  // stride between the last two, and how many times in a row it repeated.
+  struct Stream {
+    uint64_t region;
+    int64_t last_addr;
+    int64_t stride;
+    uint32_t confidence;
+    bool valid;
+  };
+
+  Line &entry(uint64_t line) {
+    return lines[(line * 0x9E3779B97F4A7C15ull) >> line_shift];
+  }
+
+  Policy policy = Policy::Off;
+  dram_prefetch_hook_t hook = nullptr;
+  void *hook_ctx = nullptr;
+  uint64_t line_size = 64;
+  uint32_t degree = 2;
+  uint32_t distance = 1;
+  uint32_t hit_latency = 1;
+  uint64_t region_size = 4096;
+  uint32_t min_confidence = 2;
+
+  // A line maps to one entry by hash, and lines sharing one evict each
+  // other, as do regions of `streams`.
+  std::vector<Line> lines;
+  uint32_t line_shift = 64;
+  std::vector<Stream> streams;
+};
+
+#endif // PREFETCHER_H
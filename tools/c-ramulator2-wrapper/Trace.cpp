@@ -0,0 +1,328 @@
+#include "./Trace.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+constexpr char TraceWriter::MAGIC[8];
+
+// Parse a decimal, or `0x` hexadecimal, address at `*text`, moving past it.
+static bool parse_addr(char** text, int64_t& out) {
+    char* start = *text;
+    int base = 10;
+    if (start[0] == '0' && (start[1] == 'x' || start[1] == 'X')) {
+        start += 2;
+        base = 16;
+    }
+    if (!std::isxdigit(static_cast<unsigned char>(*start))) {
+        return false;
+    }
+    errno = 0;
+    char* end;
+    out = static_cast<int64_t>(std::strtoull(start, &end, base));
+    *text = end;
+    return errno == 0 && (*end == '\0' || std::isspace(static_cast<unsigned char>(*end)));
+}
+
+static char* skip_space(char* text) {
+    while (std::isspace(static_cast<unsigned char>(*text))) {
+        text++;
+    }
+    return text;
+}
+
+TraceReader::~TraceReader() {
+    if (reader.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        reader.join();
+    }
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+bool TraceReader::open(const std::string& path, size_t max_chunks) {
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    char header[sizeof(TraceWriter::MAGIC)];
+    binary = std::fread(header, 1, sizeof(header), file) == sizeof(header) &&
+             std::memcmp(header, TraceWriter::MAGIC, sizeof(header) - 1) == 0 &&
+             (header[sizeof(header) - 1] == 1 || header[sizeof(header) - 1] == 2);
+    if (binary) {
+        has_ids = header[sizeof(header) - 1] == 2;
+    } else {
+        std::rewind(file);
+    }
+    this->max_chunks = max_chunks ? max_chunks : 1;
+    reader = std::thread(&TraceReader::read_all, this);
+    return true;
+}
+
+bool TraceReader::next(std::vector<TraceRecord>& out) {
+    out.clear();
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return !chunks.empty() || done; });
+    if (chunks.empty()) {
+        return false;
+    }
+    out.swap(chunks.front());
+    chunks.pop_front();
+    lock.unlock();
+    changed.notify_all();
+    return true;
+}
+
+bool TraceReader::push(std::vector<TraceRecord>& chunk) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return chunks.size() < max_chunks || stopping; });
+    if (stopping) {
+        return false;
+    }
+    chunks.push_back(std::move(chunk));
+    chunk = std::vector<TraceRecord>();
+    chunk.reserve(CHUNK_RECORDS);
+    lock.unlock();
+    changed.notify_all();
+    return true;
+}
+
+void TraceReader::read_all() {
+    std::vector<TraceRecord> chunk;
+    chunk.reserve(CHUNK_RECORDS);
+    bool more = true;
+    while (more) {
+        more = binary ? read_binary(chunk) : read_text(chunk);
+        if (!chunk.empty() && !push(chunk)) {
+            break;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    changed.notify_all();
+}
+
+// Fill `chunk` from text lines. Returns false at the end of the trace.
+bool TraceReader::read_text(std::vector<TraceRecord>& chunk) {
+    char text[512];
+    while (chunk.size() + 2 <= CHUNK_RECORDS) {
+        if (!std::fgets(text, sizeof(text), file)) {
+            return false;
+        }
+        line++;
+        if (!std::strchr(text, '\n') && !std::feof(file)) {
+            failure = "line " + std::to_string(line) + " is too long";
+            return false;
+        }
+        if (char* comment = std::strchr(text, '#')) {
+            *comment = '\0';
+        }
+        char* p = skip_space(text);
+        if (*p == '\0') {
+            continue;
+        }
+        TraceRecord records[2] = {{cycle, 0, false, 0}, {cycle, 0, true, 0}};
+        size_t n = 1;
+        bool ok;
+        if (std::isdigit(static_cast<unsigned char>(*p))) {
+            // <bubbles> <addr> [<writeback addr>]
+            int64_t bubbles;
+            ok = parse_addr(&p, bubbles) && bubbles >= 0;
+            p = skip_space(p);
+            ok = ok && parse_addr(&p, records[0].addr);
+            p = skip_space(p);
+            if (ok && *p != '\0') {
+                ok = parse_addr(&p, records[1].addr);
+                n = 2;
+            }
+            if (ok) {
+                cycle += uint64_t(bubbles);
+                records[0].cycle = records[1].cycle = cycle;
+            }
+        } else {
+            // LD <addr> / ST <addr>
+            char* op = p;
+            while (std::isalpha(static_cast<unsigned char>(*p))) {
+                p++;
+            }
+            size_t len = size_t(p - op);
+            records[0].is_write = (len == 2 && std::strncmp(op, "ST", 2) == 0) ||
+                                  (len == 1 && *op == 'W');
+            ok = records[0].is_write || (len == 2 && std::strncmp(op, "LD", 2) == 0) ||
+                 (len == 1 && *op == 'R');
+            p = skip_space(p);
+            ok = ok && parse_addr(&p, records[0].addr);
+        }
+        if (!ok || *skip_space(p) != '\0') {
+            failure = "cannot parse line " + std::to_string(line);
+            return false;
+        }
+        chunk.insert(chunk.end(), records, records + n);
+    }
+    return true;
+}
+
+static uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+static uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+// Decode one LEB128 varint. Returns false at the end of the file.
+static bool read_varint(std::FILE* file, uint64_t& out) {
+    out = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        int byte = std::getc(file);
+        if (byte == EOF) {
+            return false;
+        }
+        out |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Fill `chunk` from binary records. Returns false at the end of the trace.
+bool TraceReader::read_binary(std::vector<TraceRecord>& chunk) {
+    while (chunk.size() < CHUNK_RECORDS) {
+        uint64_t cycle_delta, addr_delta, id_delta = 0;
+        if (!read_varint(file, cycle_delta)) {
+            return false;
+        }
+        if (!read_varint(file, addr_delta) || (has_ids && !read_varint(file, id_delta))) {
+            failure = "truncated record " + std::to_string(line + 1);
+            return false;
+        }
+        line++;
+        cycle += cycle_delta >> 1;
+        addr += static_cast<int64_t>(unzigzag(addr_delta));
+        id += unzigzag(id_delta);
+        chunk.push_back(TraceRecord{cycle, addr, bool(cycle_delta & 1), id});
+    }
+    return true;
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+bool TraceWriter::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    cycle = 0;
+    addr = 0;
+    id = 0;
+    return std::fwrite(MAGIC, 1, sizeof(MAGIC), file) == sizeof(MAGIC);
+}
+
+static void write_varint(std::FILE* file, uint64_t value) {
+    uint8_t bytes[10];
+    size_t n = 0;
+    do {
+        bytes[n] = uint8_t(value & 0x7f);
+        value >>= 7;
+        bytes[n++] |= value ? 0x80 : 0;
+    } while (value);
+    std::fwrite(bytes, 1, n, file);
+}
+
+void TraceWriter::append(const TraceRecord& record) {
+    write_varint(file, ((record.cycle - cycle) << 1) | (record.is_write ? 1 : 0));
+    write_varint(file, zigzag(uint64_t(record.addr) - uint64_t(addr)));
+    write_varint(file, zigzag(record.id - id));
+    cycle = record.cycle;
+    addr = record.addr;
+    id = record.id;
+}
+
+bool TraceWriter::close() {
+    if (!file) {
+        return true;
+    }
+    bool ok = !std::ferror(file);
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+bool TraceRecorder::open(const std::string& path) {
+    close();
+    if (!writer.open(path)) {
+        writer.close();
+        return false;
+    }
+    buffer.reserve(BUFFER_RECORDS);
+    stopping = false;
+    thread = std::thread(&TraceRecorder::write_out, this);
+    return true;
+}
+
+void TraceRecorder::hand_off() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return full.size() < MAX_BUFFERS; });
+    full.push_back(std::move(buffer));
+    if (spare.empty()) {
+        buffer = std::vector<TraceRecord>();
+        buffer.reserve(BUFFER_RECORDS);
+    } else {
+        buffer = std::move(spare.back());
+        spare.pop_back();
+    }
+    lock.unlock();
+    changed.notify_all();
+}
+
+void TraceRecorder::write_out() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        changed.wait(lock, [&] { return !full.empty() || stopping; });
+        if (full.empty()) {
+            return;
+        }
+        std::vector<TraceRecord> records = std::move(full.front());
+        full.pop_front();
+        lock.unlock();
+        changed.notify_all();
+        for (const TraceRecord& record : records) {
+            writer.append(record);
+        }
+        records.clear();
+        lock.lock();
+        spare.push_back(std::move(records));
+    }
+}
+
+bool TraceRecorder::close() {
+    if (!thread.joinable()) {
+        return true;
+    }
+    if (!buffer.empty()) {
+        hand_off();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    thread.join();
+    return writer.close();
+}
@@ -0,0 +1,158 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One request of an address trace: issued no earlier than `cycle`, counted
+// from the start of the trace. `id` is the ID the wrapper gave the request
+// when it was recorded, 0 if unknown.
+struct TraceRecord {
+  uint64_t cycle;
+  int64_t addr;
+  bool is_write;
+  uint64_t id;
+};
+
+// Reads an address trace on a background thread, handing it out in chunks
+// through a bounded queue, so that parsing overlaps the simulation without
+// holding the whole trace in memory.
+//
+// Text traces take the formats of Ramulator2's own trace frontends, one
+// request per line; `#` starts a comment:
+//   LD <addr> / ST <addr>  (also R / W): back to back, in order
+//   <bubbles> <addr> [<writeback addr>]: a read `bubbles` cycles after the
+//                                         previous line, then a write
+// Addresses are decimal, or hexadecimal with `0x`. Binary traces are those
+// of `TraceWriter`, recognized by their header.
+class TraceReader {
+
+public:
+  static constexpr size_t CHUNK_RECORDS = 4096;
+
+  TraceReader() = default;
+  // Stops the reader thread, if running, and closes the file.
+  ~TraceReader();
+  TraceReader(const TraceReader &) = delete;
+  TraceReader &operator=(const TraceReader &) = delete;
+
+  // Open `path` and start reading it, with at most `max_chunks` chunks read
+  // ahead. Returns false if it cannot be opened.
+  bool open(const std::string &path, size_t max_chunks = 16);
+  bool is_binary() const { return binary; }
+
+  // Move the next chunk of records into `out`. Returns false, with `out`
+  // empty, at the end of the trace or on a parse error.
+  bool next(std::vector<TraceRecord> &out);
+  // Why reading stopped early, empty if it did not.
+  const std::string &error() const { return failure; }
+
+private:
+  void read_all();
+  bool read_text(std::vector<TraceRecord> &chunk);
+  bool read_binary(std::vector<TraceRecord> &chunk);
+  // Queue a full chunk. Returns false if the reader is being stopped.
+  bool push(std::vector<TraceRecord> &chunk);
+
+  std::FILE *file = nullptr;
+  bool binary = false;
+  bool has_ids = false;
+  size_t max_chunks = 0;
+
+  // Reader thread state.
+  uint64_t cycle = 0;
+  int64_t addr = 0;
+  uint64_t id = 0;
+  // Lines, or binary records, read so far.
+  uint64_t line = 0;
+  std::string failure;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<TraceRecord>> chunks;
+  bool done = false;
+  bool stopping = false;
+  std::thread reader;
+};
+
+// Writes the compact binary format read by `TraceReader`: an 8-byte header,
+// then per record three LEB128 varints: the cycle delta to the previous
+// record, shifted left by one with `is_write` in the low bit, and the
+// zigzagged address and ID deltas. Sequential and strided traces take 3 to 4
+// bytes a request.
+class TraceWriter {
+
+public:
+  // The last byte is the version. Version 1 had no IDs.
+  static constexpr char MAGIC[8] = {'D', 'R', 'A', 'M', 'T', 'R', 'C', '\2'};
+
+  TraceWriter() = default;
+  // Flushes and closes the file, if open.
+  ~TraceWriter();
+  TraceWriter(const TraceWriter &) = delete;
+  TraceWriter &operator=(const TraceWriter &) = delete;
+
+  // Returns false if `path` cannot be created.
+  bool open(const std::string &path);
+  // `record.cycle` must not go backwards.
+  void append(const TraceRecord &record);
+  // Returns false if anything failed to be written.
+  bool close();
+
+private:
+  std::FILE *file = nullptr;
+  uint64_t cycle = 0;
+  int64_t addr = 0;
+  uint64_t id = 0;
+};
+
+// Records a trace on the side of a simulation: `record` appends to a buffer,
+// and full buffers are encoded by a background thread, so that the caller
+// never waits for the file. Unlike samples, records are never dropped: if
+// the writer falls `MAX_BUFFERS` buffers behind, `record` waits for it.
+class TraceRecorder {
+
+public:
+  static constexpr size_t BUFFER_RECORDS = 1 << 14;
+  static constexpr size_t MAX_BUFFERS = 8;
+
+  TraceRecorder() = default;
+  // Writes out every record, if still open.
+  ~TraceRecorder();
+  TraceRecorder(const TraceRecorder &) = delete;
+  TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+  // Returns false if `path` cannot be created.
+  bool open(const std::string &path);
+  void record(const TraceRecord &record) {
+    buffer.push_back(record);
+    if (buffer.size() == BUFFER_RECORDS) {
+      hand_off();
+    }
+  }
+  // Write out every record and close the file. Returns false if anything
+  // failed to be written.
+  bool close();
+
+private:
+  void hand_off();
+  void write_out();
+
+  TraceWriter writer;
+  std::vector<TraceRecord> buffer;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<TraceRecord>> full;
+  std::vector<std::vector<TraceRecord>> spare;
+  bool stopping = false;
+  std::thread thread;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,411 @@
+#include "CRamualator2Wrapper.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Microbenchmarks of the wrapper's hot paths, written as JSON in the schema of
+// Google Benchmark, so that runs of different commits can be compared with its
+// tools. See bench.md.
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;
+    double real_seconds = 0;
+    double cpu_seconds = 0;
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+struct BenchOptions {
+    std::string config_path = "../../configs/example_config.yaml";
+    std::string out_path = "dram_bench.json";
+    std::string filter;
+    std::string label;
+    double scale = 1;
+};
+
+// Times `body`, which runs the benchmark and returns its number of iterations.
+// A body that should only be timed in part sets `real_seconds` itself.
+static BenchResult measure(const std::string& name, const std::function<uint64_t(BenchResult&)>& body) {
+    BenchResult result;
+    result.name = name;
+    std::clock_t cpu_start = std::clock();
+    auto start = std::chrono::steady_clock::now();
+    result.iterations = body(result);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (result.real_seconds == 0) {
+        result.real_seconds = elapsed.count();
+    }
+    result.cpu_seconds = double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    return result;
+}
+
+static void drain(CRamualator2Wrapper& wrapper, uint64_t& completed) {
+    dram_completion_t completions[256];
+    while (uint32_t n = wrapper.poll_completions(completions, nullptr, 256)) {
+        completed += n;
+    }
+}
+
+static void count_completion(const dram_completion_t*, const uint8_t*, void* ctx) {
+    (*static_cast<uint64_t*>(ctx))++;
+}
+
+// Ticks with nothing in flight, one frontend and memory system call per cycle.
+static uint64_t bench_empty_tick(CRamualator2Wrapper& wrapper, uint64_t cycles) {
+    for (uint64_t i = 0; i < cycles; i++) {
+        wrapper.frontend_tick();
+        wrapper.memory_system_tick();
+    }
+    return cycles;
+}
+
+// Keeps up to `in_flight` polled reads outstanding, submitting until the
+// frontend refuses or the target is reached, then ticking once.
+static uint64_t bench_in_flight(CRamualator2Wrapper& wrapper, uint64_t cycles, uint64_t in_flight,
+                                BenchResult& result) {
+    uint64_t accepted = 0, rejected = 0, completed = 0;
+    for (uint64_t i = 0; i < cycles; i++) {
+        while (accepted - completed < in_flight) {
+            if (wrapper.submit(int64_t(accepted % 1000) * 64, false, nullptr, nullptr, nullptr) == DRAM_REJECTED) {
+                rejected++;
+                break;
+            }
+            accepted++;
+        }
+        wrapper.tick_n(1, false);
+        drain(wrapper, completed);
+    }
+    result.counters.push_back({"cycles", double(cycles)});
+    result.counters.push_back({"rejected", double(rejected)});
+    return accepted;
+}
+
+// One read per cycle for `cycles` cycles, completed through `kind`:
+// a std::function, a pooled C callback, or polling.
+static uint64_t bench_completion(CRamualator2Wrapper& wrapper, uint64_t cycles, const std::string& kind) {
+    uint64_t completed = 0;
+    for (uint64_t i = 0; i < cycles; i++) {
+        int64_t addr = int64_t(i % 1000) * 64;
+        if (kind == "std_function") {
+            wrapper.send_request(addr, false, [&completed](Ramulator::Request&) { completed++; });
+        } else if (kind == "callback") {
+            wrapper.send_request(addr, false, count_completion, &completed);
+        } else {
+            wrapper.submit(addr, false, nullptr, nullptr, nullptr);
+        }
+        wrapper.tick_n(1, false);
+        drain(wrapper, completed);
+    }
+    while (wrapper.next_event_cycle() != DRAM_NO_EVENT) {
+        wrapper.tick_n(1, false);
+    }
+    drain(wrapper, completed);
+    return completed;
+}
+
+// Issues `requests` polled reads as fast as the memory accepts them, to
+// addresses from `next_addr`.
+static uint64_t bench_pattern(CRamualator2Wrapper& wrapper, uint64_t requests,
+                              const std::function<int64_t(uint64_t)>& next_addr, BenchResult& result) {
+    uint64_t completed = 0;
+    for (uint64_t i = 0; i < requests; i++) {
+        while (wrapper.submit(next_addr(i), false, nullptr, nullptr, nullptr) == DRAM_REJECTED) {
+            wrapper.tick_n(1, false);
+            drain(wrapper, completed);
+        }
+    }
+    while (wrapper.next_event_cycle() != DRAM_NO_EVENT) {
+        wrapper.tick_n(1, false);
+    }
+    drain(wrapper, completed);
+
+    dram_stats_t stats;
+    wrapper.get_stats(&stats, sizeof(stats));
+    result.counters.push_back({"cycles", double(wrapper.get_cycle())});
+    result.counters.push_back({"latency_avg", stats.latency_avg});
+    result.counters.push_back({"bandwidth_gbps", stats.bandwidth});
+    return requests;
+}
+
+// One polled read per cycle into each of `memories` instances, ticked by a
+// group of `threads` threads.
+static uint64_t bench_group(const std::string& config_path, uint64_t cycles, uint32_t memories, uint32_t threads,
+                            BenchResult& result) {
+    std::vector<std::unique_ptr<CRamualator2Wrapper>> members;
+    DramGroup group(threads);
+    for (uint32_t i = 0; i < memories; i++) {
+        members.push_back(std::make_unique<CRamualator2Wrapper>());
+        members.back()->init(config_path);
+        group.add(members.back().get());
+    }
+    // Only the ticks are timed, not the construction of the members.
+    auto start = std::chrono::steady_clock::now();
+    uint64_t completed = 0;
+    for (uint64_t i = 0; i < cycles; i++) {
+        for (auto& member : members) {
+            member->submit(int64_t(i % 1000) * 64, false, nullptr, nullptr, nullptr);
+        }
+        group.tick(1);
+        for (auto& member : members) {
+            drain(*member, completed);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.real_seconds = elapsed.count();
+    result.counters.push_back({"memory_cycles_per_second", double(cycles) * memories / elapsed.count()});
+    return cycles;
+}
+
+static std::string json_string(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+static bool write_json(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    std::ofstream out(options.out_path);
+    if (!out) {
+        return false;
+    }
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+    char number[32];
+    auto num = [&](double value) {
+        std::snprintf(number, sizeof(number), "%.9g", value);
+        return std::string(number);
+    };
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": " << json_string(date) << ",\n"
+        << "    \"executable\": \"dram_bench\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"config\": " << json_string(options.config_path) << ",\n"
+        << "    \"label\": " << json_string(options.label) << ",\n"
+        << "    \"scale\": " << num(options.scale) << "\n"
+        << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        double iterations = double(result.iterations ? result.iterations : 1);
+        out << (i ? "," : "") << "\n    {\n"
+            << "      \"name\": " << json_string(result.name) << ",\n"
+            << "      \"run_name\": " << json_string(result.name) << ",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"iterations\": " << result.iterations << ",\n"
+            << "      \"real_time\": " << num(result.real_seconds * 1e9 / iterations) << ",\n"
+            << "      \"cpu_time\": " << num(result.cpu_seconds * 1e9 / iterations) << ",\n"
+            << "      \"time_unit\": \"ns\",\n"
+            << "      \"items_per_second\": " << num(iterations / result.real_seconds);
+        for (const auto& counter : result.counters) {
+            out << ",\n      " << json_string(counter.first) << ": " << num(counter.second);
+        }
+        out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return bool(out);
+}
+
+static bool parse_options(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 == argc) {
+            if (arg[0] == '-') {
+                return false;
+            }
+            options.config_path = arg;
+        } else if (arg == "--out") {
+            options.out_path = argv[++i];
+        } else if (arg == "--filter") {
+            options.filter = argv[++i];
+        } else if (arg == "--label") {
+            options.label = argv[++i];
+        } else if (arg == "--scale") {
+            options.scale = std::atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return options.scale > 0;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parse_options(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--out <json>] [--filter <substring>] [--label <text>] "
+                             "[--scale <factor>] [<config.yaml>]\n", argv[0]);
+        return 1;
+    }
+    const std::string& config = options.config_path;
+    auto count = [&](uint64_t base) { return std::max<uint64_t>(1, uint64_t(double(base) * options.scale)); };
+
+    std::vector<BenchResult> results;
+    // Runs a benchmark on a fresh instance, unless filtered out. Instances are
+    // never finished: finish prints Ramulator2's statistics.
+    using Body = std::function<uint64_t(CRamualator2Wrapper&, BenchResult&)>;
+    // `text`, if not empty, is the config to init with instead.
+    auto run_on = [&](bool fast, const std::string& name, const Body& body, const std::string& text = "") {
+        if (name.find(options.filter) == std::string::npos) {
+            return;
+        }
+        CRamualator2Wrapper wrapper(fast);
+        wrapper.init(text.empty() ? config : text);
+        results.push_back(measure(name, [&](BenchResult& result) { return body(wrapper, result); }));
+        const BenchResult& result = results.back();
+        std::printf("%-40s %12.1f ns %14.0f items/s\n", name.c_str(),
+                    result.real_seconds * 1e9 / double(result.iterations ? result.iterations : 1),
+                    double(result.iterations) / result.real_seconds);
+    };
+    auto run = [&](const std::string& name, const Body& body) { run_on(false, name, body); };
+
+    run("tick/empty", [&](CRamualator2Wrapper& wrapper, BenchResult&) {
+        return bench_empty_tick(wrapper, count(1 << 20));
+    });
+    run("tick_n/empty", [&](CRamualator2Wrapper& wrapper, BenchResult&) {
+        uint64_t cycles = count(1 << 20);
+        wrapper.tick_n(cycles, false);
+        return cycles;
+    });
+    for (uint64_t in_flight : {1, 4, 16, 64, 256}) {
+        run("submit/in_flight:" + std::to_string(in_flight), [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+            return bench_in_flight(wrapper, count(200000), in_flight, result);
+        });
+    }
+    for (const char* kind : {"std_function", "callback", "polled"}) {
+        run(std::string("completion/") + kind, [&](CRamualator2Wrapper& wrapper, BenchResult&) {
+            return bench_completion(wrapper, count(200000), kind);
+        });
+    }
+    run("pattern/sequential", [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+        return bench_pattern(wrapper, count(200000), [](uint64_t i) { return int64_t(i * 64); }, result);
+    });
+    run("pattern/strided:8192", [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+        return bench_pattern(wrapper, count(200000), [](uint64_t i) { return int64_t(i * 8192 % (1u << 30)); },
+                             result);
+    });
+    // Adjacent words, 8 to a line, one transaction per request or per line.
+    run("pattern/words", [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+        return bench_pattern(wrapper, count(200000), [](uint64_t i) { return int64_t(i); }, result);
+    });
+    run("coalesce/line:8", [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+        wrapper.set_coalescing(8, 8);
+        uint64_t requests = bench_pattern(wrapper, count(200000), [](uint64_t i) { return int64_t(i); }, result);
+        dram_stats_t stats;
+        wrapper.get_stats(&stats, sizeof(stats));
+        result.counters.push_back({"coalesced", double(stats.coalesced_reads)});
+        return requests;
+    });
+    // The same on the fixed-latency memory, to see what Ramulator2 costs.
+    run_on(true, "fast/completion/polled", [&](CRamualator2Wrapper& wrapper, BenchResult&) {
+        return bench_completion(wrapper, count(200000), "polled");
+    });
+    run_on(true, "fast/pattern/sequential", [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+        return bench_pattern(wrapper, count(200000), [](uint64_t i) { return int64_t(i * 64); }, result);
+    });
+    // Ramulator2 for 1200 of every 10000 memory cycles, the model for the rest.
+    run("detailed/pattern/sequential", [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+        wrapper.set_detailed_windows(10000, 1000, 200);
+        uint64_t requests =
+            bench_pattern(wrapper, count(200000), [](uint64_t i) { return int64_t(i * 64); }, result);
+        dram_stats_t stats;
+        wrapper.get_stats(&stats, sizeof(stats));
+        result.counters.push_back({"est_bandwidth_gbps", stats.est_bandwidth});
+        if (stats.detailed_windows > 1) {
+            result.counters.push_back({"est_bandwidth_ci", stats.est_bandwidth_ci});
+        }
+        return requests;
+    });
+    uint64_t state = 88172645463325252ull;
+    run("pattern/random", [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+        return bench_pattern(wrapper, count(200000), [&](uint64_t) {
+            // xorshift64, over 1 GiB in 64-byte lines
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return int64_t(state % (1u << 24)) * 64;
+        }, result);
+    });
+    // One memory of 4 channels, each the config's, as a group ticks them.
+    std::ifstream config_file(config);
+    std::string config_text((std::istreambuf_iterator<char>(config_file)), std::istreambuf_iterator<char>());
+    uint32_t channel_threads = std::min(4u, std::max(1u, std::thread::hardware_concurrency()));
+    for (uint32_t threads = 1; threads <= channel_threads; threads *= 2) {
+        std::string name = "channels:4/threads:" + std::to_string(threads) + "/pattern/sequential";
+        std::string text = config_text + "\nChannels:\n  count: 4\n  threads: " + std::to_string(threads) + "\n";
+        run_on(false, name, [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+            return bench_pattern(wrapper, count(200000), [](uint64_t i) { return int64_t(i * 64); }, result);
+        }, text);
+    }
+    // The sequential pattern behind a prefetcher of the next 2 lines.
+    run_on(false, "prefetch/next_line/pattern/sequential", [&](CRamualator2Wrapper& wrapper, BenchResult& result) {
+        uint64_t requests =
+            bench_pattern(wrapper, count(200000), [](uint64_t i) { return int64_t(i * 64); }, result);
+        dram_stats_t stats;
+        wrapper.get_stats(&stats, sizeof(stats));
+        result.counters.push_back({"useful", double(stats.prefetches_useful)});
+        result.counters.push_back({"late", double(stats.prefetches_late)});
+        result.counters.push_back({"useless", double(stats.prefetches_useless)});
+        return requests;
+    }, config_text + "\nPrefetcher:\n  impl: NextLine\n  degree: 2\n");
+    // Short simulations of 16 reads, each on a new instance, or on one reset.
+    auto short_run = [](CRamualator2Wrapper& wrapper) {
+        uint64_t completed = 0;
+        for (int64_t i = 0; i < 16; i++) {
+            while (wrapper.submit(i * 64, false, nullptr, nullptr, nullptr) == DRAM_REJECTED) {
+                wrapper.tick_n(1, false);
+            }
+        }
+        while (completed < 16) {
+            wrapper.tick_n(1, false);
+            drain(wrapper, completed);
+        }
+    };
+    run("startup/new_init", [&](CRamualator2Wrapper&, BenchResult& result) {
+        uint64_t runs = count(200);
+        uint64_t parsed = ConfigCache::num_parsed();
+        for (uint64_t i = 0; i < runs; i++) {
+            CRamualator2Wrapper wrapper;
+            wrapper.init(config);
+            short_run(wrapper);
+        }
+        result.counters.push_back({"parsed", double(ConfigCache::num_parsed() - parsed)});
+        return runs;
+    });
+    run("startup/reset", [&](CRamualator2Wrapper& wrapper, BenchResult&) {
+        uint64_t runs = count(200);
+        for (uint64_t i = 0; i < runs; i++) {
+            wrapper.reset();
+            short_run(wrapper);
+        }
+        return runs;
+    });
+    const uint32_t memories = 4;
+    uint32_t max_threads = std::min<uint32_t>(memories, std::max(1u, std::thread::hardware_concurrency()));
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::string name = "group/memories:" + std::to_string(memories) + "/threads:" + std::to_string(threads);
+        run(name, [&](CRamualator2Wrapper&, BenchResult& result) {
+            return bench_group(config, count(50000), memories, threads, result);
+        });
+    }
+
+    if (!write_json(options, results)) {
+        std::fprintf(stderr, "cannot write %s\n", options.out_path.c_str());
+        return 1;
+    }
+    return 0;
+}
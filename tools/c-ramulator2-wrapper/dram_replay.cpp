@@ -0,0 +1,155 @@
+#include "CRamualator2Wrapper.h"
+#include "Trace.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Streams an address trace through one wrapper instance, as fast as the
+// memory accepts it, and reports how long the simulation took.
+
+static void usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " <config.yaml> <trace> [--core-tck <ns>] [--fast]\n"
+              << "       " << argv0 << " --convert <trace> <out.bin>\n";
+}
+
+// Rewrite a trace in the binary format of TraceWriter.
+static int convert(const std::string& in, const std::string& out) {
+    TraceReader reader;
+    if (!reader.open(in)) {
+        std::cerr << "cannot open " << in << '\n';
+        return 1;
+    }
+    TraceWriter writer;
+    if (!writer.open(out)) {
+        std::cerr << "cannot create " << out << '\n';
+        return 1;
+    }
+    uint64_t records = 0;
+    std::vector<TraceRecord> chunk;
+    while (reader.next(chunk)) {
+        for (const TraceRecord& record : chunk) {
+            writer.append(record);
+        }
+        records += chunk.size();
+    }
+    if (!reader.error().empty()) {
+        std::cerr << in << ": " << reader.error() << '\n';
+        return 1;
+    }
+    if (!writer.close()) {
+        std::cerr << "cannot write " << out << '\n';
+        return 1;
+    }
+    std::cout << "converted " << records << " requests\n";
+    return 0;
+}
+
+struct ReplayResult {
+    uint64_t requests = 0;
+    uint64_t completed = 0;
+    // Cycles the trace was held back because the memory refused a request.
+    uint64_t stall_cycles = 0;
+};
+
+// Issue every request of the trace no earlier than its cycle, shifted by the
+// stalls so far, so that the gaps of the trace are kept when the memory pushes
+// back. Requests are polled, so no callback runs inside a tick.
+static bool replay(CRamualator2Wrapper& wrapper, TraceReader& reader, ReplayResult& result) {
+    dram_completion_t completions[256];
+    std::vector<TraceRecord> chunk;
+    uint64_t delay = 0;
+    while (reader.next(chunk)) {
+        for (const TraceRecord& record : chunk) {
+            uint64_t due = record.cycle + delay;
+            if (due > wrapper.get_cycle()) {
+                if (wrapper.next_event_cycle() == DRAM_NO_EVENT) {
+                    wrapper.skip_to(due);
+                } else {
+                    wrapper.run_until(due, false);
+                }
+            }
+            while (wrapper.submit(record.addr, record.is_write, nullptr, nullptr, nullptr) == DRAM_REJECTED) {
+                wrapper.tick_n(1, false);
+                result.stall_cycles++;
+            }
+            delay = wrapper.get_cycle() - record.cycle;
+            result.requests++;
+            while (uint32_t n = wrapper.poll_completions(completions, nullptr, 256)) {
+                result.completed += n;
+            }
+        }
+    }
+    while (wrapper.next_event_cycle() != DRAM_NO_EVENT) {
+        wrapper.tick_n(1, false);
+    }
+    while (uint32_t n = wrapper.poll_completions(completions, nullptr, 256)) {
+        result.completed += n;
+    }
+    return reader.error().empty();
+}
+
+int main(int argc, char** argv) {
+    if (argc == 4 && std::strcmp(argv[1], "--convert") == 0) {
+        return convert(argv[2], argv[3]);
+    }
+    double core_tck = 0;
+    bool fast = false;
+    bool ok = argc >= 3;
+    for (int i = 3; ok && i < argc; i++) {
+        if (std::strcmp(argv[i], "--core-tck") == 0 && i + 1 < argc) {
+            core_tck = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--fast") == 0) {
+            fast = true;
+        } else {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::string trace_path = argv[2];
+
+    TraceReader reader;
+    if (!reader.open(trace_path)) {
+        std::cerr << "cannot open " << trace_path << '\n';
+        return 1;
+    }
+    CRamualator2Wrapper wrapper(fast);
+    wrapper.init(argv[1]);
+    if (core_tck > 0) {
+        wrapper.set_core_clock(core_tck);
+    }
+
+    ReplayResult result;
+    auto start = std::chrono::steady_clock::now();
+    ok = replay(wrapper, reader, result);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (!ok) {
+        std::cerr << trace_path << ": " << reader.error() << '\n';
+        return 1;
+    }
+
+    dram_stats_t stats;
+    wrapper.get_stats(&stats, sizeof(stats));
+    wrapper.finish();
+
+    double seconds = elapsed.count();
+    std::cout << "trace: " << trace_path << (reader.is_binary() ? " (binary)" : " (text)")
+              << (fast ? ", fast memory" : "") << '\n'
+              << "requests: " << result.requests << " reads: " << stats.reads
+              << " writes: " << stats.writes << " completed: " << result.completed << '\n'
+              << "cycles: " << wrapper.get_cycle() << " memory cycles: " << stats.memory_cycle
+              << " stall cycles: " << result.stall_cycles << '\n'
+              << "latency avg: " << std::fixed << std::setprecision(2) << stats.latency_avg
+              << " p99: " << stats.latency_p99 << " max: " << stats.latency_max
+              << " bandwidth GB/s: " << stats.bandwidth << '\n'
+              << "seconds: " << std::setprecision(3) << seconds
+              << " requests/sec: " << std::setprecision(0) << result.requests / seconds
+              << " cycles/sec: " << wrapper.get_cycle() / seconds << '\n';
+    return 0;
+}
@@ -1,28 +1,157 @@
 #include "CRamualator2Wrapper.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
 #include <vector>
-#include <algorithm> // for std::shuffle
-#include <random> 
 
-//This file is just for test
-int main() {
-    CRamualator2Wrapper wrapper;
+// This file is just for test: it streams 1M reads through the wrapper, once per
+// submission path and memory, Ramulator2 and FastMemory, and reports the
+// throughput of each. It then ticks several instances at once, one after
+// another and through a DramGroup.
+
+// Count heap allocations to report how many each request costs.
+static uint64_t num_allocations = 0;
+
+void* operator new(std::size_t size) {
+    num_allocations++;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+static const int NUM_REQUESTS = 1000000; // 1M cycles, one request per cycle
 
-    std::string config_path = "../../configs/example_config.yaml";;  // Adjust to your config path
+struct StreamResult {
+    uint64_t accepted = 0;
+    uint64_t completed = 0;
+    uint64_t allocations = 0;
+    double seconds = 0;
+};
+
+static void count_completion(const dram_completion_t*, const uint8_t*, void* ctx) {
+    (*static_cast<uint64_t*>(ctx))++;
+}
+
+template <typename Submit>
+static StreamResult run_stream(const std::string& config_path, bool fast, Submit submit) {
+    CRamualator2Wrapper wrapper(fast);
     wrapper.init(config_path);
-    std::vector<int64_t> stream_read_addrs, random_read_addrs;
+    StreamResult result;
 
-    
-    for (int i = 0; i < 1000000; i++) { // 1M cycles
+    uint64_t allocations_before = num_allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_REQUESTS; i++) {
         int64_t addr = i % 1000 + 1; // Addresses from 1 to 1000
-        bool is_write = false; // Alternate between read and write
-        bool ok = wrapper.send_request(addr, is_write, [](Ramulator::Request& req) {
-            std::cout << "Request completed: " << req.addr << std::endl;
-        });
+        if (submit(wrapper, addr, result.completed)) {
+            result.accepted++;
+        }
         wrapper.frontend_tick();
         wrapper.memory_system_tick();
     }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    result.allocations = num_allocations - allocations_before;
 
     wrapper.finish();
+    return result;
+}
+
+static void report(const char* name, const StreamResult& result) {
+    std::cout << std::left << std::setw(28) << name
+              << " accepted: " << result.accepted
+              << " completed: " << result.completed
+              << " seconds: " << std::fixed << std::setprecision(3) << result.seconds
+              << " requests/sec: " << std::setprecision(0) << result.accepted / result.seconds
+              << " allocations/request: " << std::setprecision(2)
+              << double(result.allocations) / result.accepted << '\n';
+}
+
+static const int NUM_GROUP_MEMORIES = 4;
+static const int NUM_GROUP_CYCLES = 200000;
+
+// Streams one polled read per cycle into each of NUM_GROUP_MEMORIES instances,
+// ticked by a group of `threads` threads (1: one after another on the caller).
+// Returns the seconds taken.
+static double run_group(const std::string& config_path, uint32_t threads, uint64_t& completed) {
+    std::vector<std::unique_ptr<CRamualator2Wrapper>> memories;
+    DramGroup group(threads);
+    for (int i = 0; i < NUM_GROUP_MEMORIES; i++) {
+        memories.push_back(std::make_unique<CRamualator2Wrapper>());
+        memories.back()->init(config_path);
+        group.add(memories.back().get());
+    }
+
+    dram_completion_t completions[64];
+    auto start = std::chrono::steady_clock::now();
+    for (int cycle = 0; cycle < NUM_GROUP_CYCLES; cycle++) {
+        for (auto& memory : memories) {
+            memory->submit(cycle % 1000 + 1, false, nullptr, nullptr, nullptr);
+        }
+        group.tick(1);
+        for (auto& memory : memories) {
+            while (uint32_t n = memory->poll_completions(completions, nullptr, 64)) {
+                completed += n;
+            }
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto& memory : memories) {
+        memory->finish();
+    }
+    return elapsed.count();
+}
+
+int main() {
+    std::string config_path = "../../configs/example_config.yaml";  // Adjust to your config path
+
+    // Before: the C shim wrapped the callback, its context and the address
+    // for its completion in a std::function per request. Those 24 bytes do
+    // not fit in its 16-byte small buffer, so each request allocates, as did
+    // the shim's [callback, ctx] once wrapped with the request's bookkeeping.
+    auto with_function = [](CRamualator2Wrapper& wrapper, int64_t addr, uint64_t& completed) {
+        dram_callback_t callback = count_completion;
+        void* ctx = &completed;
+        return wrapper.send_request(addr, false, [callback, ctx, addr](Ramulator::Request& req) {
+            dram_completion_t done{};
+            done.addr = addr;
+            done.latency = uint32_t(req.depart - req.arrive);
+            callback(&done, nullptr, ctx);
+        });
+    };
+    // After: the C path keeps the callback in a pooled slot of the wrapper.
+    auto with_slot = [](CRamualator2Wrapper& wrapper, int64_t addr, uint64_t& completed) {
+        return wrapper.send_request(addr, false, count_completion, &completed);
+    };
+
+    report("std::function", run_stream(config_path, false, with_function));
+    report("pooled slot", run_stream(config_path, false, with_slot));
+    report("std::function, FastMemory", run_stream(config_path, true, with_function));
+    report("pooled slot, FastMemory", run_stream(config_path, true, with_slot));
+
+    uint32_t threads = std::min<uint32_t>(NUM_GROUP_MEMORIES, std::max(1u, std::thread::hardware_concurrency()));
+    for (uint32_t n = 1; n <= threads; n = n == threads ? n + 1 : std::min(threads, n * 2)) {
+        uint64_t completed = 0;
+        double seconds = run_group(config_path, n, completed);
+        std::cout << "group of " << NUM_GROUP_MEMORIES << ", " << n << " thread(s)"
+                  << " completed: " << completed
+                  << " seconds: " << std::fixed << std::setprecision(3) << seconds
+                  << " cycles/sec: " << std::setprecision(0) << NUM_GROUP_CYCLES / seconds << '\n';
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -1,6 +1,5 @@
-use std::collections::VecDeque;
 use std::error::Error;
-use std::ffi::{c_char, c_void, CString};
+use std::ffi::{c_char, c_void, CStr, CString};
 
 // Platform-specific libloading imports
 #[cfg(target_os = "macos")]
@@ -52,22 +51,6 @@ macro_rules! load_library {
   }};
 }
 
-#[repr(C)]
-pub struct Request {
-  pub addr: i64,
-  pub addr_vec: Vec<i32>,
-  pub type_id: i32,
-  pub source_id: i32,
-  pub command: i32,
-  pub final_command: i32,
-  pub is_stat_updated: bool,
-  pub arrive: i64,
-  pub depart: i64,
-  pub scratchpad: [i32; 4],
-  pub callback: Option<extern "C" fn(*mut Request)>,
-  pub m_payload: *mut c_void,
-}
-
 #[repr(C)]
 pub struct Response {
   pub valid: bool,
@@ -77,42 +60,406 @@ pub struct Response {
   pub write_succ: bool,
   pub is_write: bool,
 }
+/// Mirror of `dram_completion_t`: one completed request, as polled or passed to a
+/// `RequestCallback`.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default)]
+pub struct Completion {
+  /// ID the request was given on submission.
+  pub id: u64,
+  pub addr: i64,
+  /// Memory cycle right after the tick that completed the request.
+  pub cycle: u64,
+  /// Memory cycles from arrival to departure.
+  pub latency: u32,
+  pub is_write: bool,
+  _reserved: [u8; 3],
+}
+
+/// Mirror of `dram_stats_t`: a snapshot of the counters of one memory, as returned by
+/// `MemoryInterface::stats`. Latencies are in memory cycles and cover completed requests only.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default)]
+pub struct DramStats {
+  pub struct_size: u64,
+  pub cycle: u64,
+  pub memory_cycle: u64,
+  /// Requests accepted, by type, and requests rejected.
+  pub reads: u64,
+  pub writes: u64,
+  pub rejected: u64,
+  pub reads_completed: u64,
+  pub writes_completed: u64,
+  pub outstanding: u64,
+  pub bytes_read: u64,
+  pub bytes_written: u64,
+  pub latency_sum: u64,
+  pub latency_min: u64,
+  pub latency_max: u64,
+  pub latency_p50: u64,
+  pub latency_p95: u64,
+  pub latency_p99: u64,
+  pub latency_avg: f64,
+  /// GB/s over the memory cycles so far.
+  pub bandwidth: f64,
+  pub latency_p999: u64,
+  pub read_latency_p50: u64,
+  pub read_latency_p99: u64,
+  pub read_latency_p999: u64,
+  pub read_latency_max: u64,
+  pub write_latency_p50: u64,
+  pub write_latency_p99: u64,
+  pub write_latency_p999: u64,
+  pub write_latency_max: u64,
+  pub coalesced_reads: u64,
+  pub coalesced_writes: u64,
+  /// Sampled simulation, see `MemoryInterface::set_detailed_windows`: the measured windows so
+  /// far, the memory cycles spent in detail, and the estimated mean latency and bandwidth of the
+  /// run, each with the half-width of its 95% confidence interval, NaN below two windows.
+  pub detailed_windows: u64,
+  pub detailed_memory_cycles: u64,
+  pub est_latency_avg: f64,
+  pub est_latency_ci: f64,
+  pub est_bandwidth: f64,
+  pub est_bandwidth_ci: f64,
+  /// Transactions to a bank whose last one was to another row, by the wrapper's model of the
+  /// address mapper; 0 if the mapper is not modeled.
+  pub row_switches: u64,
+  /// Prefetching, see `MemoryInterface::set_prefetch_hook`: lines read ahead, and refused by the
+  /// memory, then the prefetched lines a demand read found arrived, or on their way, and those
+  /// evicted or written to before any did.
+  pub prefetches: u64,
+  pub prefetches_dropped: u64,
+  pub prefetches_useful: u64,
+  pub prefetches_late: u64,
+  pub prefetches_useless: u64,
+}
+
+/// Mirror of `dram_sample_t`: one window of the time series `MemoryInterface::start_sampling`
+/// takes, and one record of its binary output. Counts cover the window only.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default)]
+pub struct DramSample {
+  pub memory_cycle: u64,
+  pub cycle: u64,
+  pub bytes_read: u64,
+  pub bytes_written: u64,
+  pub reads_completed: u32,
+  pub writes_completed: u32,
+  pub rejected: u32,
+  /// Requests in flight at the end of the window.
+  pub outstanding: u32,
+  /// Requests in flight, summed over the memory cycles of the window.
+  pub occupancy_sum: u64,
+  pub latency_sum: u64,
+}
+
+impl DramSample {
+  /// Parse the binary output of `start_sampling`, records in native byte order.
+  pub fn parse(bytes: &[u8]) -> Vec<DramSample> {
+    bytes
+      .chunks_exact(std::mem::size_of::<DramSample>())
+      .map(|record| unsafe { std::ptr::read_unaligned(record.as_ptr() as *const DramSample) })
+      .collect()
+  }
+}
+
+/// Completions drained by one `MemoryInterface::poll_completions` call, with their data.
+///
+/// The buffers are reused from one poll to the next.
+#[derive(Default)]
+pub struct CompletionBatch {
+  completions: Vec<Completion>,
+  data: Vec<u8>,
+  word_bytes: usize,
+  len: usize,
+}
+
+impl CompletionBatch {
+  pub fn new() -> Self {
+    Self::default()
+  }
+
+  pub fn len(&self) -> usize {
+    self.len
+  }
+
+  pub fn is_empty(&self) -> bool {
+    self.len == 0
+  }
+
+  /// Iterate over the completions, each with its data: the word read, as of completion, for
+  /// reads, and zeros for writes.
+  pub fn iter(&self) -> impl Iterator<Item = (&Completion, &[u8])> {
+    let word_bytes = self.word_bytes.max(1);
+    self.completions[..self.len]
+      .iter()
+      .zip(self.data.chunks(word_bytes))
+  }
+}
+
+/// Completions of polled requests borrowed in place from the queue of the wrapper, as returned
+/// by `MemoryInterface::peek_completions`.
+pub struct BorrowedCompletions<'a> {
+  completions: &'a [Completion],
+  data: &'a [u8],
+  word_bytes: usize,
+}
+
+impl<'a> BorrowedCompletions<'a> {
+  pub fn len(&self) -> usize {
+    self.completions.len()
+  }
+
+  pub fn is_empty(&self) -> bool {
+    self.completions.is_empty()
+  }
+
+  /// Iterate over the completions, each with its data, as `CompletionBatch::iter` does.
+  pub fn iter(&self) -> impl Iterator<Item = (&'a Completion, &'a [u8])> {
+    let word_bytes = self.word_bytes.max(1);
+    self.completions.iter().zip(self.data.chunks(word_bytes))
+  }
+}
+
 type CRamualator2Wrapper = *mut c_void;
-pub type RequestCallback = extern "C" fn(*mut Request, *mut c_void);
+type CDramGroup = *mut c_void;
+/// Returned by `dram_submit` when the frontend rejects the request.
+pub const DRAM_REJECTED: u64 = 0;
+/// Returned by `MemoryInterface::next_event_cycle` when no request is in flight.
+pub const DRAM_NO_EVENT: u64 = u64::MAX;
+/// Completion callback: the completion, its data (one word, as in `CompletionBatch::iter`)
+/// and the context given on submission. Both pointers are only valid during the call.
+pub type RequestCallback = extern "C" fn(*const Completion, *const u8, *mut c_void);
+/// Prefetch hook: given the address of a demand read, writes at most `max` addresses to prefetch
+/// to `out` and returns how many, with the context it was set with. It must not call into the
+/// wrapper.
+pub type PrefetchHook = extern "C" fn(i64, *mut i64, u32, *mut c_void) -> u32;
+
+/// Mirror of `dram_vtable_t` in `CRamualator2Wrapper.h`: every entry point of the wrapper,
+/// resolved once through `dram_get_vtable`.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct DramVTable {
+  pub struct_size: u64,
+  pub dram_new: unsafe extern "C" fn() -> CRamualator2Wrapper,
+  pub dram_delete: unsafe extern "C" fn(CRamualator2Wrapper),
+  pub dram_init: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char),
+  pub get_memory_tck: unsafe extern "C" fn(CRamualator2Wrapper) -> f32,
+  pub send_request:
+    unsafe extern "C" fn(CRamualator2Wrapper, i64, bool, RequestCallback, *mut c_void) -> bool,
+  pub finish: unsafe extern "C" fn(CRamualator2Wrapper),
+  pub frontend_tick: unsafe extern "C" fn(CRamualator2Wrapper),
+  pub memory_system_tick: unsafe extern "C" fn(CRamualator2Wrapper),
+  pub tick_n: unsafe extern "C" fn(CRamualator2Wrapper, u64, bool) -> u64,
+  pub run_until: unsafe extern "C" fn(CRamualator2Wrapper, u64, bool) -> u64,
+  pub get_cycle: unsafe extern "C" fn(CRamualator2Wrapper) -> u64,
+  pub next_event_cycle: unsafe extern "C" fn(CRamualator2Wrapper) -> u64,
+  pub skip_to: unsafe extern "C" fn(CRamualator2Wrapper, u64) -> u64,
+  pub config_store: unsafe extern "C" fn(CRamualator2Wrapper, u32, u64),
+  pub load_hex: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char) -> bool,
+  pub send_write:
+    unsafe extern "C" fn(CRamualator2Wrapper, i64, *const u8, RequestCallback, *mut c_void) -> bool,
+  pub read_data: unsafe extern "C" fn(CRamualator2Wrapper, i64, *mut u8),
+  pub load_image: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char, u64) -> bool,
+  pub send_requests: unsafe extern "C" fn(
+    CRamualator2Wrapper,
+    *const i64,
+    *const bool,
+    u32,
+    *const u8,
+    RequestCallback,
+    *mut c_void,
+    *mut u64,
+  ) -> u32,
+  pub submit: unsafe extern "C" fn(
+    CRamualator2Wrapper,
+    i64,
+    bool,
+    *const u8,
+    Option<RequestCallback>,
+    *mut c_void,
+  ) -> u64,
+  pub next_request_id: unsafe extern "C" fn(CRamualator2Wrapper) -> u64,
+  pub poll_completions:
+    unsafe extern "C" fn(CRamualator2Wrapper, *mut Completion, *mut u8, u32) -> u32,
+  pub group_new: unsafe extern "C" fn(u32) -> CDramGroup,
+  pub group_delete: unsafe extern "C" fn(CDramGroup),
+  pub group_add: unsafe extern "C" fn(CDramGroup, CRamualator2Wrapper),
+  pub group_tick: unsafe extern "C" fn(CDramGroup, u64),
+  pub set_core_clock: unsafe extern "C" fn(CRamualator2Wrapper, f64),
+  pub get_memory_cycle: unsafe extern "C" fn(CRamualator2Wrapper) -> u64,
+  pub get_stats: unsafe extern "C" fn(CRamualator2Wrapper, *mut DramStats, u32) -> u32,
+  pub dump_latency_csv: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char) -> bool,
+  pub set_latency_csv: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char),
+  pub start_sampling: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char, u64, bool) -> bool,
+  pub stop_sampling: unsafe extern "C" fn(CRamualator2Wrapper),
+  pub start_trace: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char) -> bool,
+  pub stop_trace: unsafe extern "C" fn(CRamualator2Wrapper) -> bool,
+  pub checkpoint: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char) -> bool,
+  pub restore: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char) -> bool,
+  pub get_word_bytes: unsafe extern "C" fn(CRamualator2Wrapper) -> u32,
+  pub set_coalescing: unsafe extern "C" fn(CRamualator2Wrapper, u64, u64),
+  pub dram_new_fast: unsafe extern "C" fn() -> CRamualator2Wrapper,
+  pub set_detailed_windows: unsafe extern "C" fn(CRamualator2Wrapper, u64, u64, u64) -> bool,
+  pub dram_init_mapped: unsafe extern "C" fn(CRamualator2Wrapper, *const c_char, *const c_char),
+  pub decode_addr: unsafe extern "C" fn(CRamualator2Wrapper, i64, *mut i64, u32) -> u32,
+  pub addr_level_name: unsafe extern "C" fn(CRamualator2Wrapper, u32) -> *const c_char,
+  pub peek_completions:
+    unsafe extern "C" fn(CRamualator2Wrapper, *mut *const Completion, *mut *const u8) -> u32,
+  pub release_completions: unsafe extern "C" fn(CRamualator2Wrapper, u32),
+  pub queue_free_slots: unsafe extern "C" fn(CRamualator2Wrapper) -> u32,
+  pub num_channels: unsafe extern "C" fn(CRamualator2Wrapper) -> u32,
+  pub channel_occupancy: unsafe extern "C" fn(CRamualator2Wrapper, u32) -> u32,
+  pub dram_reset: unsafe extern "C" fn(CRamualator2Wrapper),
+  pub set_prefetch_hook:
+    unsafe extern "C" fn(CRamualator2Wrapper, Option<PrefetchHook>, *mut c_void),
+}
 
 pub struct MemoryInterface {
-  lib: Library,
+  // Keeps the function pointers in `vtable` valid.
+  _lib: Library,
+  vtable: DramVTable,
   wrapper: CRamualator2Wrapper,
-  pub write_buffer: VecDeque<(usize, Vec<u8>)>,
+  // Word size of the backing store, as set by `config_store`.
+  word_bytes: usize,
 }
 
 impl MemoryInterface {
   /// Create a new MemoryInterface from a loaded library.
   ///
+  /// All the entry points are resolved here, once, through `dram_get_vtable`.
+  ///
   /// # Safety
   ///
-  /// The library must be valid and contain the required symbols.
+  /// The library must be valid and export `dram_get_vtable`.
   pub unsafe fn new(lib: Library) -> Result<Self, Box<dyn Error>> {
-    let dram_new: Symbol<unsafe extern "C" fn() -> CRamualator2Wrapper> = lib.get(b"dram_new")?;
-    let wrapper = dram_new();
+    Self::load(lib, false)
+  }
+
+  /// Create a new MemoryInterface on a fixed-latency memory instead of Ramulator2's, configured
+  /// by the `FastMemory` section of the config given to `init`, if any.
+  ///
+  /// # Safety
+  ///
+  /// The library must be valid and export `dram_get_vtable`.
+  pub unsafe fn new_fast(lib: Library) -> Result<Self, Box<dyn Error>> {
+    Self::load(lib, true)
+  }
+
+  unsafe fn load(lib: Library, fast: bool) -> Result<Self, Box<dyn Error>> {
+    let dram_get_vtable: Symbol<unsafe extern "C" fn() -> *const DramVTable> =
+      lib.get(b"dram_get_vtable")?;
+    let vtable = *dram_get_vtable();
+    if (vtable.struct_size as usize) < std::mem::size_of::<DramVTable>() {
+      return Err("libwrapper is older than sim-runtime, please rebuild it".into());
+    }
+    let wrapper = if fast {
+      (vtable.dram_new_fast)()
+    } else {
+      (vtable.dram_new)()
+    };
 
     Ok(Self {
-      lib,
+      _lib: lib,
+      vtable,
       wrapper,
-      write_buffer: VecDeque::new(),
+      word_bytes: 4,
     })
   }
 
-  /// Initialize the memory interface with a configuration file.
+  /// Initialize the memory interface with a configuration file, or with the
+  /// YAML text of the configuration if `config` spans several lines.
+  ///
+  /// # Safety
+  ///
+  /// The config must not contain a null byte.
+  pub unsafe fn init(&self, config: &str) {
+    let c_config = CString::new(config).unwrap();
+    (self.vtable.dram_init)(self.wrapper, c_config.as_ptr());
+  }
+
+  /// Same as `init`, with the `AddrMapper` of the configuration replaced by `mapper`, e.g.
+  /// `"ChRaBaRoCo"`.
+  ///
+  /// # Safety
+  ///
+  /// Neither string may contain a null byte.
+  pub unsafe fn init_with_mapper(&self, config: &str, mapper: &str) {
+    let c_config = CString::new(config).unwrap();
+    let c_mapper = CString::new(mapper).unwrap();
+    (self.vtable.dram_init_mapped)(self.wrapper, c_config.as_ptr(), c_mapper.as_ptr());
+  }
+
+  /// Decode `addr` into its index at each level of the DRAM organization, channel first, column
+  /// last, as the configuration's address mapper does. Empty if the wrapper does not model the
+  /// configuration's standard or mapper.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized.
+  pub unsafe fn decode_addr(&self, addr: i64) -> Vec<i64> {
+    let mut levels = vec![0; 8];
+    let n = (self.vtable.decode_addr)(self.wrapper, addr, levels.as_mut_ptr(), levels.len() as u32);
+    levels.truncate(n as usize);
+    levels
+  }
+
+  /// Names of the levels of `decode_addr`, e.g. `"bankgroup"`.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized.
+  pub unsafe fn addr_levels(&self) -> Vec<String> {
+    let mut names = Vec::new();
+    loop {
+      let name = (self.vtable.addr_level_name)(self.wrapper, names.len() as u32);
+      if name.is_null() {
+        return names;
+      }
+      names.push(CStr::from_ptr(name).to_string_lossy().into_owned());
+    }
+  }
+
+  /// Return to the state `init` left, at cycle 0, with nothing in flight, cleared statistics and
+  /// a cleared backing store of the same shape, without parsing the configuration again. Requests
+  /// in flight are dropped without completing, and what was set after `init`, from coalescing
+  /// to the trace, is turned off, the outputs written first.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized.
+  pub unsafe fn reset(&self) {
+    (self.vtable.dram_reset)(self.wrapper);
+  }
+
+  /// Requests the memory is expected to take before it rejects one: exact for a fast memory,
+  /// estimated per channel for Ramulator2, whose buffers are not exposed. A design holding back
+  /// while this is 0 resends fewer rejected requests.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized.
+  pub unsafe fn queue_free_slots(&self) -> u32 {
+    (self.vtable.queue_free_slots)(self.wrapper)
+  }
+
+  /// Channels of the memory, numbered as the channel level of `decode_addr`.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized.
+  pub unsafe fn num_channels(&self) -> u32 {
+    (self.vtable.num_channels)(self.wrapper)
+  }
+
+  /// Transactions in flight in `channel`, 0 past the last one.
   ///
   /// # Safety
   ///
-  /// The config_path must be a valid null-terminated string.
-  pub unsafe fn init(&self, config_path: &str) {
-    let c_path = CString::new(config_path).unwrap();
-    let dram_init: Symbol<unsafe extern "C" fn(CRamualator2Wrapper, *const c_char)> =
-      self.lib.get(b"dram_init").unwrap();
-    dram_init(self.wrapper, c_path.as_ptr());
+  /// The wrapper must be initialized.
+  pub unsafe fn channel_occupancy(&self, channel: u32) -> u32 {
+    (self.vtable.channel_occupancy)(self.wrapper, channel)
   }
 
   /// Advance the frontend by one tick.
@@ -121,9 +468,7 @@ impl MemoryInterface {
   ///
   /// The wrapper must be in a valid state.
   pub unsafe fn frontend_tick(&self) {
-    let frontend_tick: Symbol<unsafe extern "C" fn(CRamualator2Wrapper)> =
-      self.lib.get(b"frontend_tick").unwrap();
-    frontend_tick(self.wrapper);
+    (self.vtable.frontend_tick)(self.wrapper);
   }
 
   /// Advance the memory system by one tick.
@@ -132,9 +477,202 @@ impl MemoryInterface {
   ///
   /// The wrapper must be in a valid state.
   pub unsafe fn memory_system_tick(&self) {
-    let memory_system_tick: Symbol<unsafe extern "C" fn(CRamualator2Wrapper)> =
-      self.lib.get(b"memory_system_tick").unwrap();
-    memory_system_tick(self.wrapper);
+    (self.vtable.memory_system_tick)(self.wrapper);
+  }
+
+  /// Advance the frontend and the memory system together by one tick.
+  ///
+  /// This is equivalent to `frontend_tick` followed by `memory_system_tick`,
+  /// but crosses the FFI boundary only once.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn tick(&self) {
+    self.tick_n(1, false);
+  }
+
+  /// Advance the frontend and the memory system together by up to `n` ticks.
+  ///
+  /// Completion callbacks fire as the requests complete. If `stop_on_completion` is set, this
+  /// returns right after the first tick in which a request completed. Returns the number of
+  /// ticks actually advanced.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state, and every pending callback context must be valid.
+  pub unsafe fn tick_n(&self, n: u64, stop_on_completion: bool) -> u64 {
+    (self.vtable.tick_n)(self.wrapper, n, stop_on_completion)
+  }
+
+  /// Advance the memory until its cycle counter reaches `cycle`.
+  ///
+  /// See `tick_n` for `stop_on_completion` and the return value.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state, and every pending callback context must be valid.
+  pub unsafe fn run_until(&self, cycle: u64, stop_on_completion: bool) -> u64 {
+    (self.vtable.run_until)(self.wrapper, cycle, stop_on_completion)
+  }
+
+  /// Get the number of cycles since `init`: memory system ticks, or core cycles once
+  /// `set_core_clock` is called.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn cycle(&self) -> u64 {
+    (self.vtable.get_cycle)(self.wrapper)
+  }
+
+  /// Clock the memory system at its own period against a core clock of period `core_tck`
+  /// ns. Each cycle then ticks the memory system as many times as its cycles fit in a core
+  /// cycle, possibly none. 0 goes back to one memory tick per cycle.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized.
+  pub unsafe fn set_core_clock(&self, core_tck: f64) {
+    (self.vtable.set_core_clock)(self.wrapper, core_tck);
+  }
+
+  /// Get the number of memory system ticks since `init`.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn memory_cycle(&self) -> u64 {
+    (self.vtable.get_memory_cycle)(self.wrapper)
+  }
+
+  /// Take a snapshot of the counters of the memory. Cheap enough to call mid-run.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized.
+  pub unsafe fn stats(&self) -> DramStats {
+    let mut stats = DramStats::default();
+    (self.vtable.get_stats)(self.wrapper, &mut stats, std::mem::size_of::<DramStats>() as u32);
+    stats
+  }
+
+  /// Write the read and write latency histograms of the memory to `path` as CSV, one
+  /// `type,low,high,count` line per non-empty bucket. Returns false if it cannot be opened.
+  ///
+  /// # Safety
+  ///
+  /// The path must not contain a null byte.
+  pub unsafe fn dump_latency_csv(&self, path: &str) -> bool {
+    let c_path = CString::new(path).unwrap();
+    (self.vtable.dump_latency_csv)(self.wrapper, c_path.as_ptr())
+  }
+
+  /// Dump the latency histograms to `path`, as `dump_latency_csv` does, when the memory is
+  /// dropped. An empty path dumps nothing.
+  ///
+  /// # Safety
+  ///
+  /// The path must not contain a null byte.
+  pub unsafe fn set_latency_csv(&self, path: &str) {
+    let c_path = CString::new(path).unwrap();
+    (self.vtable.set_latency_csv)(self.wrapper, c_path.as_ptr());
+  }
+
+  /// Record a `DramSample` every `interval` memory cycles, written to `path` by a background
+  /// thread of the wrapper, as CSV or, with `binary`, as raw records. Replaces any sampling
+  /// in progress. Returns false if `path` cannot be opened.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized, and the path must not contain a null byte.
+  pub unsafe fn start_sampling(&self, path: &str, interval: u64, binary: bool) -> bool {
+    let c_path = CString::new(path).unwrap();
+    (self.vtable.start_sampling)(self.wrapper, c_path.as_ptr(), interval, binary)
+  }
+
+  /// Record the window in progress and write out every sample. Dropping the memory does it
+  /// too.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn stop_sampling(&self) {
+    (self.vtable.stop_sampling)(self.wrapper);
+  }
+
+  /// Record every accepted request to `path`, in the binary trace format of the wrapper's
+  /// `dram_replay`, encoded by a background thread of the wrapper. Replaces any recording in
+  /// progress. Returns false if `path` cannot be created.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized, and the path must not contain a null byte.
+  pub unsafe fn start_trace(&self, path: &str) -> bool {
+    let c_path = CString::new(path).unwrap();
+    (self.vtable.start_trace)(self.wrapper, c_path.as_ptr())
+  }
+
+  /// Write out every record and close the trace. Dropping the memory does it too. Returns
+  /// false if anything failed to be written.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn stop_trace(&self) -> bool {
+    (self.vtable.stop_trace)(self.wrapper)
+  }
+
+  /// Save the state the wrapper owns to `path`: clocks, request IDs, stats, polled
+  /// completions not taken yet, and the backing store. Requests in flight are drained first,
+  /// ticking until they complete, since Ramulator2's own state cannot be saved: checkpointing
+  /// advances the clock. Returns false if `path` cannot be written.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized, the callbacks of requests in flight must still be valid,
+  /// and the path must not contain a null byte.
+  pub unsafe fn checkpoint(&self, path: &str) -> bool {
+    let c_path = CString::new(path).unwrap();
+    (self.vtable.checkpoint)(self.wrapper, c_path.as_ptr())
+  }
+
+  /// Load a checkpoint into this memory, which must be initialized with nothing in flight.
+  /// The memory system itself starts cold. Returns false if the file cannot be read or comes
+  /// from another build of the wrapper, leaving the memory unchanged.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be initialized, and the path must not contain a null byte.
+  pub unsafe fn restore(&mut self, path: &str) -> bool {
+    let c_path = CString::new(path).unwrap();
+    let restored = (self.vtable.restore)(self.wrapper, c_path.as_ptr());
+    self.word_bytes = (self.vtable.get_word_bytes)(self.wrapper) as usize;
+    restored
+  }
+
+  /// Get the earliest cycle at which a completion may arrive.
+  ///
+  /// Exact on a fast memory and for reads served by the prefetch buffer; the
+  /// next cycle while Ramulator2 holds a request. Returns `DRAM_NO_EVENT` if
+  /// no request is in flight.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn next_event_cycle(&self) -> u64 {
+    (self.vtable.next_event_cycle)(self.wrapper)
+  }
+
+  /// Fast-forward the memory to `cycle`, stopping right after the first completion.
+  ///
+  /// Idle stretches are skipped without ticking the memory system. Returns the cycle reached.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state, and every pending callback context must be valid.
+  pub unsafe fn skip_to(&self, cycle: u64) -> u64 {
+    (self.vtable.skip_to)(self.wrapper, cycle)
   }
 
   /// Get the memory clock period.
@@ -144,9 +682,7 @@ impl MemoryInterface {
   /// The wrapper must be in a valid state.
   #[allow(non_snake_case)]
   pub unsafe fn get_memory_tCK(&self) -> f32 {
-    let get_memory_tck: Symbol<unsafe extern "C" fn(CRamualator2Wrapper) -> f32> =
-      self.lib.get(b"get_memory_tCK").unwrap();
-    get_memory_tck(self.wrapper)
+    (self.vtable.get_memory_tck)(self.wrapper)
   }
 
   /// Send a memory request.
@@ -161,10 +697,7 @@ impl MemoryInterface {
     callback: RequestCallback,
     ctx: *mut c_void,
   ) -> bool {
-    let send_request: Symbol<
-      unsafe extern "C" fn(CRamualator2Wrapper, i64, bool, RequestCallback, *mut c_void) -> bool,
-    > = self.lib.get(b"send_request").unwrap();
-    send_request(self.wrapper, addr, is_write, callback, ctx)
+    (self.vtable.send_request)(self.wrapper, addr, is_write, callback, ctx)
   }
 
   /// Finish the memory interface.
@@ -173,37 +706,305 @@ impl MemoryInterface {
   ///
   /// The wrapper must be in a valid state.
   pub unsafe fn finish(&self) {
-    let my_finish: Symbol<unsafe extern "C" fn(CRamualator2Wrapper)> =
-      self.lib.get(b"finish").unwrap();
-    my_finish(self.wrapper);
+    (self.vtable.finish)(self.wrapper);
   }
 
-  /// Reset the write buffer and response state.
-  pub fn reset_state(&mut self) {
-    self.write_buffer.clear();
+  /// Set the word size (in bytes) and the depth (in words) of the backing store.
+  ///
+  /// A depth of 0 means unknown. This drops all the data held by the store.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state, with no write in flight.
+  pub unsafe fn config_store(&mut self, word_bytes: usize, num_words: u64) {
+    self.word_bytes = word_bytes.max(1);
+    (self.vtable.config_store)(self.wrapper, self.word_bytes as u32, num_words);
   }
 
-  /// Add data to the write buffer for a write request.
-  pub fn add_write_data(&mut self, addr: usize, data: Vec<u8>) {
-    self.write_buffer.push_back((addr, data));
+  /// Get the word size of the backing store in bytes.
+  pub fn word_bytes(&self) -> usize {
+    self.word_bytes
   }
 
-  /// Get write data for a given address and remove it from the buffer.
-  pub fn get_write_data(&mut self, addr: usize) -> Option<Vec<u8>> {
-    if let Some(pos) = self.write_buffer.iter().position(|(a, _)| *a == addr) {
-      Some(self.write_buffer.remove(pos).unwrap().1)
-    } else {
-      None
+  /// Preload the backing store from a hex file, in the format of `load_hex_file`.
+  ///
+  /// Returns false if the file cannot be opened.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn load_hex(&self, path: &str) -> bool {
+    let c_path = CString::new(path).unwrap();
+    (self.vtable.load_hex)(self.wrapper, c_path.as_ptr())
+  }
+
+  /// Preload a raw little-endian image at word `base_addr` if `path` ends in `.bin`, or else
+  /// a hex file.
+  ///
+  /// Page-aligned parts of a raw image are mapped from the file rather than copied, so the
+  /// cost does not grow with the image size. Returns false if the file cannot be opened, or
+  /// is loaded as a hex file but is not plain text.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn load_image(&self, path: &str, base_addr: u64) -> bool {
+    let c_path = CString::new(path).unwrap();
+    (self.vtable.load_image)(self.wrapper, c_path.as_ptr(), base_addr)
+  }
+
+  /// Send a write request carrying one word of data.
+  ///
+  /// The data is copied by the wrapper, and committed to the backing store when the request
+  /// completes.
+  ///
+  /// # Safety
+  ///
+  /// The callback and ctx must be valid for the duration of the request.
+  pub unsafe fn send_write(
+    &self,
+    addr: i64,
+    data: &[u8],
+    callback: RequestCallback,
+    ctx: *mut c_void,
+  ) -> bool {
+    assert!(data.len() >= self.word_bytes, "write data is narrower than a word");
+    (self.vtable.send_write)(self.wrapper, addr, data.as_ptr(), callback, ctx)
+  }
+
+  /// Send a memory request, returning its ID, or `None` if the frontend rejected it.
+  ///
+  /// IDs increase by one per accepted request, and come back in the `Completion`, so that
+  /// in-flight requests can be tracked in an `Outstanding` table.
+  /// With `data` (one word, as in `send_write`), a write commits it to the backing store.
+  /// Without a callback, the request is polled: its completion is collected by
+  /// `poll_completions` instead.
+  ///
+  /// # Safety
+  ///
+  /// The callback and ctx must be valid for the duration of the request.
+  pub unsafe fn submit(
+    &self,
+    addr: i64,
+    is_write: bool,
+    data: Option<&[u8]>,
+    callback: Option<RequestCallback>,
+    ctx: *mut c_void,
+  ) -> Option<u64> {
+    let data = match data {
+      Some(data) => {
+        assert!(data.len() >= self.word_bytes, "write data is narrower than a word");
+        data.as_ptr()
+      }
+      None => std::ptr::null(),
+    };
+    match (self.vtable.submit)(self.wrapper, addr, is_write, data, callback, ctx) {
+      DRAM_REJECTED => None,
+      id => Some(id),
     }
   }
+
+  /// Drain up to `max` completions of polled requests into `batch`, oldest first.
+  ///
+  /// Returns the number of completions drained, which are then found in `batch`.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn poll_completions(&self, batch: &mut CompletionBatch, max: usize) -> usize {
+    batch.completions.resize(max, Completion::default());
+    batch.data.resize(max * self.word_bytes, 0);
+    batch.word_bytes = self.word_bytes;
+    batch.len = (self.vtable.poll_completions)(
+      self.wrapper,
+      batch.completions.as_mut_ptr(),
+      batch.data.as_mut_ptr(),
+      max as u32,
+    ) as usize;
+    batch.len
+  }
+
+  /// Borrow the oldest completions of polled requests in place, without copying them or their
+  /// data out, as many as follow each other in the queue of the wrapper. Fewer than are queued
+  /// may be returned when its ring wraps around: the rest follows once these are released.
+  ///
+  /// # Safety
+  ///
+  /// The completions stay queued, and borrowed, until `release_completions` drops them: the
+  /// memory must neither tick nor have its store configured or restored before then, and the
+  /// view must not be used after.
+  pub unsafe fn peek_completions<'a>(&self) -> BorrowedCompletions<'a> {
+    let mut completions: *const Completion = std::ptr::null();
+    let mut data: *const u8 = std::ptr::null();
+    let len = (self.vtable.peek_completions)(self.wrapper, &mut completions, &mut data) as usize;
+    if len == 0 {
+      return BorrowedCompletions {
+        completions: &[],
+        data: &[],
+        word_bytes: self.word_bytes,
+      };
+    }
+    BorrowedCompletions {
+      completions: std::slice::from_raw_parts(completions, len),
+      data: std::slice::from_raw_parts(data, len * self.word_bytes),
+      word_bytes: self.word_bytes,
+    }
+  }
+
+  /// Drop the `count` oldest completions of polled requests, those of a `peek_completions`.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn release_completions(&self, count: usize) {
+    (self.vtable.release_completions)(self.wrapper, count as u32);
+  }
+
+  /// Get the ID the next accepted request will be given.
+  ///
+  /// The requests a batch accepts get consecutive IDs from this one, in order.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn next_request_id(&self) -> u64 {
+    (self.vtable.next_request_id)(self.wrapper)
+  }
+
+  /// Merge requests to the same line of `line_size` addresses into one transaction of the
+  /// memory system: reads join the read of their line in flight, and writes the write of their
+  /// line sent at most `write_window` cycles before. Merged requests keep their own ID and
+  /// completion, delivered along with the transaction's. 0 turns coalescing off.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn set_coalescing(&self, line_size: u64, write_window: u64) {
+    (self.vtable.set_coalescing)(self.wrapper, line_size, write_window);
+  }
+
+  /// Prefetch the addresses `hook` returns for each demand read, in place of the policy of the
+  /// configuration's `Prefetcher` section, or, with `None`, go back to it. Prefetched lines are
+  /// read by the wrapper alone; a demand read finding its line completes from it, and
+  /// `stats` counts the useful, late and useless prefetches.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state, and `ctx` valid while the hook is set.
+  pub unsafe fn set_prefetch_hook(&self, hook: Option<PrefetchHook>, ctx: *mut c_void) {
+    (self.vtable.set_prefetch_hook)(self.wrapper, hook, ctx);
+  }
+
+  /// Sampled simulation: of every `period` memory cycles, only the first `warmup + window` go
+  /// through Ramulator2, and the rest through a latency model calibrated on the latencies of the
+  /// last measured `window`. `stats` then estimates the run's latency and bandwidth from the
+  /// windows. 0 turns it off. Returns false on a fast instance, with requests in flight, or if
+  /// the windows do not leave the model a cycle of the period.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn set_detailed_windows(&mut self, period: u64, window: u64, warmup: u64) -> bool {
+    (self.vtable.set_detailed_windows)(self.wrapper, period, window, warmup)
+  }
+
+  /// Send a batch of requests with a single FFI call.
+  ///
+  /// Every request is tried, so a rejected one does not keep the following ones out. `data`
+  /// holds one word per request (only read for writes), or is `None` for timing-only writes.
+  /// On return, bit `i` of `accepted` (resized to one bit per request) is set if request `i`
+  /// was accepted. Returns the number of accepted requests.
+  ///
+  /// # Safety
+  ///
+  /// The callback and ctx must be valid for the duration of every accepted request.
+  pub unsafe fn send_requests(
+    &self,
+    addrs: &[i64],
+    is_write: &[bool],
+    data: Option<&[u8]>,
+    callback: RequestCallback,
+    ctx: *mut c_void,
+    accepted: &mut Vec<u64>,
+  ) -> u32 {
+    assert_eq!(addrs.len(), is_write.len(), "one write flag per address");
+    let data = match data {
+      Some(data) => {
+        assert!(data.len() >= addrs.len() * self.word_bytes, "one word of data per request");
+        data.as_ptr()
+      }
+      None => std::ptr::null(),
+    };
+    accepted.resize(addrs.len().div_ceil(64), 0);
+    (self.vtable.send_requests)(
+      self.wrapper,
+      addrs.as_ptr(),
+      is_write.as_ptr(),
+      addrs.len() as u32,
+      data,
+      callback,
+      ctx,
+      accepted.as_mut_ptr(),
+    )
+  }
+
+  /// Read the word at `addr` from the backing store into `out`, resized to one word.
+  ///
+  /// # Safety
+  ///
+  /// The wrapper must be in a valid state.
+  pub unsafe fn read_data(&self, addr: i64, out: &mut Vec<u8>) {
+    out.resize(self.word_bytes, 0);
+    (self.vtable.read_data)(self.wrapper, addr, out.as_mut_ptr());
+  }
 }
 
 impl Drop for MemoryInterface {
   fn drop(&mut self) {
     unsafe {
-      let dram_delete: Symbol<unsafe extern "C" fn(CRamualator2Wrapper)> =
-        self.lib.get(b"dram_delete").unwrap();
-      dram_delete(self.wrapper);
+      (self.vtable.dram_delete)(self.wrapper);
+    }
+  }
+}
+
+/// Several memory interfaces ticked in parallel by a pool of threads of the wrapper.
+pub struct DramGroup {
+  vtable: DramVTable,
+  group: CDramGroup,
+}
+
+impl DramGroup {
+  /// Group `members` under `threads` threads, the calling one included; 0 picks the
+  /// hardware concurrency.
+  ///
+  /// # Safety
+  ///
+  /// The members must outlive the group, which borrows the entry points of the first one's
+  /// library. `members` must not be empty.
+  pub unsafe fn new(members: &[&MemoryInterface], threads: usize) -> Self {
+    let vtable = members[0].vtable;
+    let group = (vtable.group_new)(threads as u32);
+    for member in members {
+      (vtable.group_add)(group, member.wrapper);
+    }
+    Self { vtable, group }
+  }
+
+  /// Tick every member `n` times, in parallel, and return once all of them are done.
+  ///
+  /// # Safety
+  ///
+  /// Completion callbacks run on worker threads, so they must not touch shared state.
+  /// Polled requests are safe: their completions stay queued in each member.
+  pub unsafe fn tick(&self, n: u64) {
+    (self.vtable.group_tick)(self.group, n);
+  }
+}
+
+impl Drop for DramGroup {
+  fn drop(&mut self) {
+    unsafe {
+      (self.vtable.group_delete)(self.group);
     }
   }
 }
@@ -253,4 +1054,10 @@ impl MemoryInterface {
     let lib_path = cwrapper_lib_path()?;
     Self::new_from_path(&lib_path)
   }
+
+  /// Same as `new_from_cwrapper_path`, on a fixed-latency memory
+  pub fn new_fast_from_cwrapper_path() -> Result<Self, Box<dyn Error>> {
+    let lib = load_library!(&cwrapper_lib_path()?);
+    unsafe { Self::new_fast(lib) }
+  }
 }
@@ -1,7 +1,9 @@
 pub mod cast;
+pub mod outstanding;
 pub mod utils;
 pub mod xeq;
 
 pub use cast::*;
+pub use outstanding::*;
 pub use utils::*;
 pub use xeq::*;
@@ -0,0 +1,73 @@
+use std::collections::VecDeque;
+
+/// Values of in-flight requests, indexed by the request IDs a DRAM wrapper assigns.
+///
+/// IDs increase by one per accepted request, so the entries from the oldest in-flight ID on
+/// are kept in a dense window: both `insert` and `remove` are O(1) amortized, without hashing,
+/// and two requests to the same address never collide.
+pub struct Outstanding<T> {
+  // ID of `entries[0]`.
+  base: u64,
+  entries: VecDeque<Option<T>>,
+  len: usize,
+}
+
+impl<T> Default for Outstanding<T> {
+  fn default() -> Self {
+    Self::new()
+  }
+}
+
+impl<T> Outstanding<T> {
+  pub fn new() -> Self {
+    Outstanding {
+      base: 0,
+      entries: VecDeque::new(),
+      len: 0,
+    }
+  }
+
+  /// Track `value` under `id`, which must be newer than every ID inserted so far.
+  ///
+  /// IDs that are skipped, e.g. those of untracked requests, leave holes in the window.
+  pub fn insert(&mut self, id: u64, value: T) {
+    if self.entries.is_empty() {
+      self.base = id;
+    }
+    let offset = id
+      .checked_sub(self.base)
+      .filter(|offset| *offset as usize >= self.entries.len())
+      .expect("request IDs must be inserted in increasing order") as usize;
+    self.entries.resize_with(offset, || None);
+    self.entries.push_back(Some(value));
+    self.len += 1;
+  }
+
+  /// Stop tracking `id`, returning its value if it was tracked.
+  pub fn remove(&mut self, id: u64) -> Option<T> {
+    let offset = id.checked_sub(self.base)? as usize;
+    let value = self.entries.get_mut(offset)?.take()?;
+    self.len -= 1;
+    // Completions may come out of order: the window only shrinks from the oldest entry.
+    while let Some(None) = self.entries.front() {
+      self.entries.pop_front();
+      self.base += 1;
+    }
+    Some(value)
+  }
+
+  /// Get the value tracked under `id`.
+  pub fn get(&self, id: u64) -> Option<&T> {
+    let offset = id.checked_sub(self.base)? as usize;
+    self.entries.get(offset)?.as_ref()
+  }
+
+  /// Number of tracked requests.
+  pub fn len(&self) -> usize {
+    self.len
+  }
+
+  pub fn is_empty(&self) -> bool {
+    self.len == 0
+  }
+}
@@ -29,3 +29,12 @@ pub fn load_hex_file<T: Num>(array: &mut [T], init_file: &str) {
     idx += 1;
   }
 }
+
+/// The little-endian value of the first 8 bytes, or fewer, of `bytes`.
+pub fn le_word(bytes: &[u8]) -> u64 {
+  bytes
+    .iter()
+    .take(8)
+    .rev()
+    .fold(0, |word, &byte| (word << 8) | u64::from(byte))
+}
@@ -2,27 +2,55 @@ use std::env;
 use std::ffi::c_void;
 use std::path::Path;
 
-use sim_runtime::ramulator2::{MemoryInterface, Request};
+use sim_runtime::ramulator2::{
+  Completion, CompletionBatch, DramGroup, DramSample, MemoryInterface, DRAM_NO_EVENT,
+};
+use sim_runtime::Outstanding;
 
-extern "C" fn request_callback(req: *mut Request, ctx: *mut c_void) {
+extern "C" fn request_callback(done: *const Completion, _data: *const u8, ctx: *mut c_void) {
   unsafe {
     let cycle = *(ctx as *const i32);
-    let request = &*req;
+    let done = &*done;
     println!(
       "Cycle {}: Request completed: {} the data is: {}",
-      cycle + 3 + (request.depart - request.arrive) as i32,
-      request.addr,
-      request.addr - 1
+      cycle + 3 + done.latency as i32,
+      done.addr,
+      done.addr - 1
     );
   }
 }
 
-#[test]
-fn test_ramulator2_outputs_match_cpp() -> Result<(), Box<dyn std::error::Error>> {
+extern "C" fn count_callback(_done: *const Completion, _data: *const u8, ctx: *mut c_void) {
+  unsafe {
+    *(ctx as *mut u32) += 1;
+  }
+}
+
+/// Keeps the ID and the data of the completion in a `(u64, Vec<u8>)` of 8-byte words.
+extern "C" fn copy_data_callback(done: *const Completion, data: *const u8, ctx: *mut c_void) {
+  unsafe {
+    let read = &mut *(ctx as *mut (u64, Vec<u8>));
+    *read = ((*done).id, std::slice::from_raw_parts(data, 8).to_vec());
+  }
+}
+
+extern "C" fn record_id_callback(done: *const Completion, _data: *const u8, ctx: *mut c_void) {
+  unsafe {
+    (*(ctx as *mut Vec<u64>)).push((*done).id);
+  }
+}
+
+fn example_config_path() -> String {
   let home = env::var("ASSASSYN_HOME")
     .unwrap_or_else(|_| env::current_dir().unwrap().to_string_lossy().to_string());
   let config_path = format!("{}/tools/c-ramulator2-wrapper/configs/example_config.yaml", home);
   assert!(Path::new(&config_path).exists(), "Config file not found at {}", config_path);
+  config_path
+}
+
+#[test]
+fn test_ramulator2_outputs_match_cpp() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
 
   let memory = MemoryInterface::new_from_cwrapper_path()?;
 
@@ -70,3 +98,1359 @@ fn test_ramulator2_outputs_match_cpp() -> Result<(), Box<dyn std::error::Error>>
   }
   Ok(())
 }
+
+#[test]
+fn test_tick_n_stops_on_completion() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut completed = 0u32;
+
+  unsafe {
+    memory.init(&config_path);
+    assert_eq!(memory.tick_n(10, false), 10);
+    assert_eq!(memory.cycle(), 10);
+
+    let ctx = &mut completed as *mut u32 as *mut c_void;
+    assert!(memory.send_request(0x40, false, count_callback, ctx));
+    let advanced = memory.tick_n(10_000, true);
+    assert!(advanced < 10_000, "the read never completed");
+    assert_eq!(completed, 1);
+    assert_eq!(memory.cycle(), 10 + advanced);
+
+    let target = memory.cycle() + 5;
+    assert_eq!(memory.run_until(target, false), 5);
+    assert_eq!(memory.run_until(target, false), 0);
+    memory.finish();
+  }
+  Ok(())
+}
+
+#[test]
+fn test_skip_to_stops_at_completion() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut completed = 0u32;
+
+  unsafe {
+    memory.init(&config_path);
+    assert_eq!(memory.next_event_cycle(), DRAM_NO_EVENT);
+    assert_eq!(memory.skip_to(1_000), 1_000);
+
+    let ctx = &mut completed as *mut u32 as *mut c_void;
+    assert!(memory.send_request(0x40, false, count_callback, ctx));
+    assert_eq!(memory.next_event_cycle(), 1_001);
+    let reached = memory.skip_to(100_000);
+    assert!(reached < 100_000, "the read never completed");
+    assert_eq!(completed, 1);
+    assert_eq!(memory.next_event_cycle(), DRAM_NO_EVENT);
+    assert_eq!(memory.skip_to(100_000), 100_000);
+    memory.finish();
+  }
+  Ok(())
+}
+
+#[test]
+fn test_backing_store_commits_writes_at_completion() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut completed = 0u32;
+  let mut word = Vec::new();
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(8, 1 << 20);
+    memory.read_data(0x40, &mut word);
+    assert_eq!(word, vec![0; 8]);
+
+    let ctx = &mut completed as *mut u32 as *mut c_void;
+    let data = [1, 2, 3, 4, 5, 6, 7, 8];
+    assert!(memory.send_write(0x40, &data, count_callback, ctx));
+    memory.read_data(0x40, &mut word);
+    assert_eq!(word, vec![0; 8], "the write is visible before it completes");
+    let advanced = memory.tick_n(10_000, true);
+    assert!(advanced < 10_000, "the write never completed");
+    memory.read_data(0x40, &mut word);
+    assert_eq!(word, data);
+
+    // Words beyond the depth are backed by sparse pages.
+    assert!(memory.send_write(1 << 30, &data, count_callback, ctx));
+    memory.tick_n(10_000, true);
+    memory.read_data(1 << 30, &mut word);
+    assert_eq!(word, data);
+    assert_eq!(completed, 2);
+
+    // A read callback gets the word as of completion, and the completion record.
+    let mut read = (0u64, Vec::new());
+    let ctx = &mut read as *mut (u64, Vec<u8>) as *mut c_void;
+    let id = memory
+      .submit(0x40, false, None, Some(copy_data_callback), ctx)
+      .unwrap();
+    memory.tick_n(10_000, true);
+    assert_eq!(read, (id, data[..8].to_vec()));
+    memory.finish();
+  }
+  Ok(())
+}
+
+#[test]
+fn test_backing_store_loads_hex_file() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let hex_path = env::temp_dir().join(format!("dram_init_{}.hex", std::process::id()));
+  std::fs::write(&hex_path, "// header\n1234_5678\n@10\ndeadbeef // comment\n")?;
+  let mut word = Vec::new();
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(4, 0);
+    assert!(memory.load_hex(hex_path.to_str().unwrap()));
+    memory.read_data(0, &mut word);
+    assert_eq!(word, vec![0x78, 0x56, 0x34, 0x12]);
+    memory.read_data(0x10, &mut word);
+    assert_eq!(word, vec![0xef, 0xbe, 0xad, 0xde]);
+    memory.read_data(1, &mut word);
+    assert_eq!(word, vec![0; 4]);
+    assert!(!memory.load_hex("/nonexistent/dram_init.hex"));
+    // Not named *.bin: the same file through `load_image`, at word 0x20.
+    assert!(memory.load_image(hex_path.to_str().unwrap(), 0x20));
+    memory.read_data(0x30, &mut word);
+    assert_eq!(word, vec![0xef, 0xbe, 0xad, 0xde]);
+    memory.finish();
+  }
+  std::fs::remove_file(&hex_path)?;
+  Ok(())
+}
+
+#[test]
+fn test_backing_store_loads_raw_image() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let image_path = env::temp_dir().join(format!("dram_image_{}.bin", std::process::id()));
+  // Two full pages and a partial one, so that both the mapped and the copied paths are taken.
+  let image: Vec<u8> = (0..(8192 + 100) as u32).map(|i| (i % 251) as u8).collect();
+  std::fs::write(&image_path, &image)?;
+  let path = image_path.to_str().unwrap();
+  let mut word = Vec::new();
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(4, 1 << 16);
+    // Page-aligned, mapped from the file.
+    assert!(memory.load_image(path, 1024));
+    for addr in [0u64, 1, 1024, 2047, 2048, 3072, 3072 + 24] {
+      memory.read_data(addr as i64, &mut word);
+      let expected = if (1024..1024 + image.len() as u64 / 4).contains(&addr) {
+        let offset = (addr - 1024) as usize * 4;
+        image[offset..offset + 4].to_vec()
+      } else {
+        vec![0; 4]
+      };
+      assert_eq!(word, expected, "word {}", addr);
+    }
+    // Unaligned, copied; beyond the depth, copied into sparse pages.
+    for base in [3u64, 1 << 20] {
+      assert!(memory.load_image(path, base));
+      memory.read_data(base as i64 + 1, &mut word);
+      assert_eq!(word, image[4..8]);
+    }
+    // Writes land in the store, never in the file.
+    let ctx = &mut 0u32 as *mut u32 as *mut c_void;
+    assert!(memory.send_write(1024, &[9, 9, 9, 9], count_callback, ctx));
+    memory.tick_n(10_000, true);
+    memory.read_data(1024, &mut word);
+    assert_eq!(word, vec![9; 4]);
+    // The same bytes under another name are taken for a hex file, and refused.
+    let misnamed = format!("{path}.hex");
+    std::fs::write(&misnamed, &image)?;
+    assert!(!memory.load_image(&misnamed, 0));
+    assert!(!memory.load_hex(&misnamed));
+    std::fs::remove_file(&misnamed)?;
+    memory.read_data(0, &mut word);
+    assert_eq!(word, vec![0; 4]);
+    memory.finish();
+  }
+  assert_eq!(std::fs::read(&image_path)?, image);
+  std::fs::remove_file(&image_path)?;
+  Ok(())
+}
+
+#[test]
+fn test_send_requests_reports_accepted_bitmap() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut completed = 0u32;
+  let mut accepted = Vec::new();
+  let mut word = Vec::new();
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(4, 1 << 16);
+    let ctx = &mut completed as *mut u32 as *mut c_void;
+
+    // More requests than the frontend can hold at once.
+    let addrs: Vec<i64> = (0..200).map(|i| i * 64).collect();
+    let is_write: Vec<bool> = (0..200).map(|i| i % 2 == 1).collect();
+    let data: Vec<u8> = (0..200u32).flat_map(|i| i.to_le_bytes()).collect();
+    let num_accepted =
+      memory.send_requests(&addrs, &is_write, Some(&data), count_callback, ctx, &mut accepted);
+    assert_eq!(accepted.len(), 4);
+    assert_eq!(accepted.iter().map(|w| w.count_ones()).sum::<u32>(), num_accepted);
+    assert!(num_accepted > 0 && num_accepted < 200, "expected a partial batch");
+
+    memory.run_until(memory.cycle() + 10_000, false);
+    assert_eq!(completed, num_accepted);
+    for i in 0..200usize {
+      memory.read_data(addrs[i], &mut word);
+      let written = is_write[i] && accepted[i / 64] >> (i % 64) & 1 == 1;
+      let expected = if written {
+        (i as u32).to_le_bytes().to_vec()
+      } else {
+        vec![0; 4]
+      };
+      assert_eq!(word, expected, "request {}", i);
+    }
+
+    assert_eq!(memory.send_requests(&[], &[], None, count_callback, ctx, &mut accepted), 0);
+    assert!(accepted.is_empty());
+    memory.finish();
+  }
+  Ok(())
+}
+
+#[test]
+fn test_request_ids_track_repeated_addresses() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut completed: Vec<u64> = Vec::new();
+  let mut table = Outstanding::new();
+
+  unsafe {
+    memory.init(&config_path);
+    let ctx = &mut completed as *mut Vec<u64> as *mut c_void;
+    let first = memory.next_request_id();
+    // The same address again and again: every request still gets its own entry.
+    for stamp in 0..8usize {
+      let id = memory
+        .submit(0x40, false, None, Some(record_id_callback), ctx)
+        .unwrap();
+      assert_eq!(id, first + stamp as u64);
+      table.insert(id, stamp);
+    }
+    assert_eq!(table.len(), 8);
+    memory.run_until(memory.cycle() + 10_000, false);
+    assert_eq!(completed.len(), 8);
+    let mut stamps: Vec<usize> = completed
+      .iter()
+      .map(|id| table.remove(*id).unwrap())
+      .collect();
+    stamps.sort();
+    assert_eq!(stamps, (0..8).collect::<Vec<_>>());
+    assert!(table.is_empty());
+    memory.finish();
+  }
+  Ok(())
+}
+
+#[test]
+fn test_outstanding_removes_out_of_order() {
+  let mut table = Outstanding::new();
+  table.insert(1, 10);
+  table.insert(2, 20);
+  // IDs of untracked requests leave holes.
+  table.insert(5, 50);
+  assert_eq!(table.len(), 3);
+  assert_eq!(table.remove(2), Some(20));
+  assert_eq!(table.remove(2), None);
+  assert_eq!(table.get(1), Some(&10));
+  assert_eq!(table.remove(1), Some(10));
+  assert_eq!(table.remove(3), None);
+  assert_eq!(table.remove(5), Some(50));
+  assert!(table.is_empty());
+  table.insert(7, 70);
+  assert_eq!(table.remove(7), Some(70));
+}
+
+#[test]
+fn test_poll_completions_delivers_ids_and_data() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut batch = CompletionBatch::new();
+  let null = std::ptr::null_mut();
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(4, 1 << 16);
+    let write = memory
+      .submit(0x40, true, Some(&[1, 2, 3, 4]), None, null)
+      .unwrap();
+    assert_eq!(memory.poll_completions(&mut batch, 16), 0);
+    memory.tick_n(10_000, true);
+    assert_eq!(memory.poll_completions(&mut batch, 16), 1);
+    let (done, data) = batch.iter().next().unwrap();
+    assert_eq!((done.id, done.addr, done.is_write), (write, 0x40, true));
+    assert_eq!(done.cycle, memory.cycle());
+    assert_eq!(data, [0; 4]);
+
+    // A read takes its data at completion, not when it is polled.
+    let read = memory.submit(0x40, false, None, None, null).unwrap();
+    memory.tick_n(10_000, true);
+    memory
+      .submit(0x40, true, Some(&[9, 9, 9, 9]), None, null)
+      .unwrap();
+    memory.tick_n(10_000, true);
+    assert_eq!(memory.poll_completions(&mut batch, 16), 2);
+    let polled: Vec<_> = batch
+      .iter()
+      .map(|(done, data)| (done.id, data.to_vec()))
+      .collect();
+    assert_eq!(polled[0], (read, vec![1, 2, 3, 4]));
+
+    // Completions left unpolled are kept, in order, past the initial ring capacity.
+    let first = memory.next_request_id();
+    let mut accepted = 0;
+    while accepted < 1000 {
+      if memory
+        .submit(accepted * 64, false, None, None, null)
+        .is_some()
+      {
+        accepted += 1;
+      }
+      memory.tick();
+    }
+    memory.run_until(memory.cycle() + 10_000, false);
+    let mut ids = Vec::new();
+    while memory.poll_completions(&mut batch, 64) != 0 {
+      ids.extend(batch.iter().map(|(done, _)| done.id));
+    }
+    ids.sort();
+    assert_eq!(ids, (first..first + 1000).collect::<Vec<_>>());
+    memory.finish();
+  }
+  Ok(())
+}
+
+#[test]
+fn test_dram_group_ticks_like_serial() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let null = std::ptr::null_mut();
+  let mut batch = CompletionBatch::new();
+
+  // The same request streams through three memories ticked one after another, then through
+  // three ticked by a group: the completions must match exactly.
+  type Completed = Vec<(u64, i64, u64, u32)>;
+  let mut run = |grouped: bool| -> Result<Completed, Box<dyn std::error::Error>> {
+    let memories = (0..3)
+      .map(|_| MemoryInterface::new_from_cwrapper_path())
+      .collect::<Result<Vec<_>, _>>()?;
+    let mut completions = Vec::new();
+    unsafe {
+      for memory in &memories {
+        memory.init(&config_path);
+      }
+      let refs: Vec<&MemoryInterface> = memories.iter().collect();
+      let group = DramGroup::new(&refs, 3);
+      for cycle in 0..2000 {
+        for (i, memory) in memories.iter().enumerate() {
+          if cycle % (i + 1) == 0 {
+            memory.submit((cycle * 64 + i) as i64, cycle % 5 == 0, None, None, null);
+          }
+        }
+        if grouped {
+          group.tick(1 + cycle as u64 % 3);
+        } else {
+          for memory in &memories {
+            memory.tick_n(1 + cycle as u64 % 3, false);
+          }
+        }
+        for memory in &memories {
+          while memory.poll_completions(&mut batch, 64) != 0 {
+            completions.extend(
+              batch
+                .iter()
+                .map(|(done, _)| (done.id, done.addr, done.cycle, done.latency)),
+            );
+          }
+        }
+      }
+      drop(group);
+      for memory in &memories {
+        memory.finish();
+      }
+    }
+    Ok(completions)
+  };
+
+  let serial = run(false)?;
+  assert!(!serial.is_empty());
+  assert_eq!(run(true)?, serial);
+  Ok(())
+}
+
+#[test]
+fn test_core_clock_scales_memory_ticks() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let null = std::ptr::null_mut();
+  let mut batch = CompletionBatch::new();
+
+  // Latency of one read, in wrapper cycles, with the core clock at `ratio` times the memory
+  // clock period (0: no core clock).
+  let mut run = |ratio: f64| -> Result<(u64, u64, u32), Box<dyn std::error::Error>> {
+    let memory = MemoryInterface::new_from_cwrapper_path()?;
+    unsafe {
+      memory.init(&config_path);
+      if ratio != 0.0 {
+        memory.set_core_clock(memory.get_memory_tCK() as f64 * ratio);
+      }
+      let issued = memory.cycle();
+      memory.submit(0x80, false, None, None, null).unwrap();
+      memory.tick_n(100_000, true);
+      assert_eq!(memory.poll_completions(&mut batch, 1), 1);
+      let (done, _) = batch.iter().next().unwrap();
+      let (cycles, latency) = (done.cycle - issued, done.latency);
+      memory.tick_n(1000, false);
+      Ok((cycles, memory.memory_cycle() * 1000 / memory.cycle(), latency))
+    }
+  };
+
+  let (base, _, latency) = run(0.0)?;
+  // A core twice as fast as the memory waits twice as many of its cycles, for the same
+  // memory latency, while the memory system ticks every other core cycle.
+  let (fast, mem_per_1000, fast_latency) = run(0.5)?;
+  assert_eq!(fast_latency, latency);
+  assert!(fast.abs_diff(2 * base) <= 2, "{fast} vs 2 x {base}");
+  assert_eq!(mem_per_1000, 500);
+  // A core 4 times slower ticks the memory 4 times per cycle.
+  let (slow, mem_per_1000, _) = run(4.0)?;
+  assert!(slow.abs_diff(base / 4) <= 1, "{slow} vs {base} / 4");
+  assert_eq!(mem_per_1000, 4000);
+  Ok(())
+}
+
+#[test]
+fn test_stats_count_requests_and_latencies() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut batch = CompletionBatch::new();
+  let null = std::ptr::null_mut();
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(8, 1 << 16);
+    let stats = memory.stats();
+    assert_eq!(stats.struct_size as usize, std::mem::size_of_val(&stats));
+    assert_eq!((stats.reads, stats.latency_p50, stats.bandwidth), (0, 0, 0.0));
+
+    let mut latencies = Vec::new();
+    for i in 0..40 {
+      while memory
+        .submit(i * 64, i % 4 == 0, None, None, null)
+        .is_none()
+      {
+        memory.tick();
+      }
+      memory.tick();
+      // Sampled mid-run: counts move as requests are submitted and complete.
+      assert_eq!(memory.stats().reads + memory.stats().writes, i as u64 + 1);
+      memory.poll_completions(&mut batch, 64);
+      latencies.extend(batch.iter().map(|(done, _)| done.latency as u64));
+    }
+    assert!(memory.stats().outstanding > 0);
+    memory.tick_n(10_000, false);
+    memory.poll_completions(&mut batch, 64);
+    latencies.extend(batch.iter().map(|(done, _)| done.latency as u64));
+    latencies.sort();
+
+    let stats = memory.stats();
+    assert_eq!((stats.reads, stats.writes), (30, 10));
+    assert_eq!((stats.reads_completed, stats.writes_completed), (30, 10));
+    assert_eq!(stats.outstanding, 0);
+    assert_eq!((stats.bytes_read, stats.bytes_written), (240, 80));
+    assert_eq!(stats.latency_sum, latencies.iter().sum::<u64>());
+    assert_eq!(stats.latency_min, latencies[0]);
+    assert_eq!(stats.latency_max, latencies[39]);
+    assert_eq!(stats.latency_p50, latencies[19]);
+    assert_eq!(stats.latency_p99, latencies[39]);
+    assert_eq!(stats.memory_cycle, memory.memory_cycle());
+    let elapsed_ns = stats.memory_cycle as f64 * memory.get_memory_tCK() as f64;
+    assert!((stats.bandwidth - 320.0 / elapsed_ns).abs() < 1e-9);
+    memory.finish();
+  }
+  Ok(())
+}
+
+#[test]
+fn test_latency_histogram_splits_reads_and_writes() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let csv_path = env::temp_dir().join(format!("dram_latency_{}.csv", std::process::id()));
+  let csv_path = csv_path.to_str().unwrap();
+  let mut batch = CompletionBatch::new();
+  let null = std::ptr::null_mut();
+  let (mut reads, mut writes) = (Vec::new(), Vec::new());
+
+  {
+    let memory = MemoryInterface::new_from_cwrapper_path()?;
+    unsafe {
+      memory.init(&config_path);
+      memory.set_latency_csv(csv_path);
+      let mut submitted = 0;
+      while submitted < 1000 {
+        if memory
+          .submit(submitted * 64, submitted % 3 == 0, None, None, null)
+          .is_some()
+        {
+          submitted += 1;
+        }
+        memory.tick();
+        memory.poll_completions(&mut batch, 64);
+        for (done, _) in batch.iter() {
+          let latencies = if done.is_write {
+            &mut writes
+          } else {
+            &mut reads
+          };
+          latencies.push(done.latency as u64);
+        }
+      }
+      memory.tick_n(100_000, false);
+      memory.poll_completions(&mut batch, 1000);
+      for (done, _) in batch.iter() {
+        let latencies = if done.is_write {
+          &mut writes
+        } else {
+          &mut reads
+        };
+        latencies.push(done.latency as u64);
+      }
+      reads.sort();
+      writes.sort();
+
+      // Below 256 cycles the buckets are one cycle wide, so percentiles are exact.
+      let stats = memory.stats();
+      assert_eq!(stats.read_latency_max, *reads.last().unwrap());
+      assert_eq!(stats.write_latency_max, *writes.last().unwrap());
+      if stats.latency_max < 256 {
+        assert_eq!(stats.read_latency_p50, reads[reads.len().div_ceil(2) - 1]);
+        assert_eq!(stats.write_latency_p99, writes[(writes.len() * 99).div_ceil(100) - 1]);
+      }
+      assert!(stats.latency_p99 <= stats.latency_p999 && stats.latency_p999 <= stats.latency_max);
+    }
+    // Dropping the memory dumps its histograms.
+  }
+
+  let csv = std::fs::read_to_string(csv_path)?;
+  std::fs::remove_file(csv_path)?;
+  let mut lines = csv.lines();
+  assert_eq!(lines.next(), Some("type,low,high,count"));
+  let (mut read_count, mut write_count) = (0, 0);
+  for line in lines {
+    let fields: Vec<&str> = line.split(',').collect();
+    let (low, high, count): (u64, u64, usize) =
+      (fields[1].parse()?, fields[2].parse()?, fields[3].parse()?);
+    let latencies = match fields[0] {
+      "read" => {
+        read_count += count;
+        &reads
+      }
+      _ => {
+        write_count += count;
+        &writes
+      }
+    };
+    let in_bucket = latencies.iter().filter(|&&l| l >= low && l <= high).count();
+    assert_eq!(in_bucket, count, "{line}");
+  }
+  assert_eq!((read_count, write_count), (reads.len(), writes.len()));
+  Ok(())
+}
+
+#[test]
+fn test_sampling_windows_add_up_to_stats() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let csv_path = env::temp_dir().join(format!("dram_samples_{}.csv", std::process::id()));
+  let bin_path = env::temp_dir().join(format!("dram_samples_{}.bin", std::process::id()));
+  let (csv_path, bin_path) = (csv_path.to_str().unwrap(), bin_path.to_str().unwrap());
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut batch = CompletionBatch::new();
+  let null = std::ptr::null_mut();
+
+  let samples = unsafe {
+    memory.init(&config_path);
+    memory.config_store(8, 1 << 16);
+    // 100 memory cycles in, so windows end on cycles 100 + k * 64.
+    memory.tick_n(100, false);
+    assert!(memory.start_sampling(csv_path, 64, false));
+    assert!(memory.start_sampling(bin_path, 64, true));
+    for i in 0..2000 {
+      if i < 1500 {
+        memory.submit(i * 64, i % 4 == 0, None, None, null);
+      }
+      memory.tick();
+      memory.poll_completions(&mut batch, 64);
+    }
+    memory.stop_sampling();
+    DramSample::parse(&std::fs::read(bin_path)?)
+  };
+  std::fs::remove_file(bin_path)?;
+
+  // 2000 cycles: 31 whole windows, and the 16 cycles of the last one.
+  assert_eq!(samples.len(), 32);
+  assert_eq!(samples[0].memory_cycle, 164);
+  assert_eq!(samples[31].memory_cycle, 2100);
+  let stats = unsafe { memory.stats() };
+  let sum = |field: fn(&DramSample) -> u64| samples.iter().map(field).sum::<u64>();
+  assert_eq!(sum(|s| s.bytes_read), stats.bytes_read);
+  assert_eq!(sum(|s| s.bytes_written), stats.bytes_written);
+  assert_eq!(sum(|s| s.rejected as u64), stats.rejected);
+  assert_eq!(sum(|s| s.latency_sum), stats.latency_sum);
+  assert_eq!(samples[31].outstanding as u64, stats.outstanding);
+  // The memory stays busy while requests keep coming.
+  assert!(samples[..20].iter().all(|s| s.occupancy_sum > 0));
+
+  // The CSV file, replaced by the binary one, holds its header only.
+  let csv = std::fs::read_to_string(csv_path)?;
+  std::fs::remove_file(csv_path)?;
+  assert_eq!(csv.lines().count(), 1);
+  assert!(csv.starts_with("memory_cycle,cycle,bytes_read,"));
+  Ok(())
+}
+
+/// Decodes a trace of `start_trace`: `(cycle, addr, is_write, id)` per record.
+fn parse_trace(bytes: &[u8]) -> Vec<(u64, i64, bool, u64)> {
+  assert_eq!(&bytes[..8], b"DRAMTRC\x02");
+  let mut varints = Vec::new();
+  let (mut value, mut shift) = (0u64, 0);
+  for byte in &bytes[8..] {
+    value |= ((byte & 0x7f) as u64) << shift;
+    shift += 7;
+    if byte & 0x80 == 0 {
+      varints.push(value);
+      (value, shift) = (0, 0);
+    }
+  }
+  let unzigzag = |v: u64| (v >> 1) ^ (v & 1).wrapping_neg();
+  let (mut cycle, mut addr, mut id) = (0u64, 0i64, 0u64);
+  varints
+    .chunks_exact(3)
+    .map(|record| {
+      cycle += record[0] >> 1;
+      addr = addr.wrapping_add(unzigzag(record[1]) as i64);
+      id = id.wrapping_add(unzigzag(record[2]));
+      (cycle, addr, record[0] & 1 == 1, id)
+    })
+    .collect()
+}
+
+#[test]
+fn test_trace_records_accepted_requests() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let trace_path = env::temp_dir().join(format!("dram_trace_{}.bin", std::process::id()));
+  let trace_path = trace_path.to_str().unwrap();
+  let memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut batch = CompletionBatch::new();
+  let null = std::ptr::null_mut();
+
+  let mut expected = Vec::new();
+  unsafe {
+    memory.init(&config_path);
+    // Requests before the trace starts are not recorded, but count towards IDs.
+    memory.submit(0, false, None, None, null);
+    memory.tick();
+    assert!(memory.start_trace(trace_path));
+    // Several per cycle, so that some are rejected, until past one buffer of the recorder.
+    let mut i = 0i64;
+    while expected.len() <= 1 << 14 {
+      for j in 0..4 {
+        let addr = (i * 4 + j) * 64 - 256;
+        if let Some(id) = memory.submit(addr, j == 3, None, None, null) {
+          expected.push((memory.cycle(), addr, j == 3, id));
+        }
+      }
+      memory.tick();
+      memory.poll_completions(&mut batch, 64);
+      i += 1;
+    }
+    assert!(memory.stop_trace());
+    assert!(memory.stop_trace());
+  }
+  let records = parse_trace(&std::fs::read(trace_path)?);
+  std::fs::remove_file(trace_path)?;
+
+  assert!(unsafe { memory.stats() }.rejected > 0);
+  assert_eq!(expected[0].3, 2);
+  assert_eq!(records, expected);
+  Ok(())
+}
+
+/// Reads every word of `0..n` through polled requests, returning the `(id, data)` of each.
+unsafe fn read_back(memory: &MemoryInterface, n: i64) -> Vec<(u64, Vec<u8>)> {
+  let mut batch = CompletionBatch::new();
+  let mut reads = Vec::new();
+  let mut addr = 0;
+  while reads.len() < n as usize {
+    if addr < n
+      && memory
+        .submit(addr, false, None, None, std::ptr::null_mut())
+        .is_some()
+    {
+      addr += 1;
+    }
+    memory.tick();
+    memory.poll_completions(&mut batch, 64);
+    reads.extend(batch.iter().map(|(done, data)| (done.id, data.to_vec())));
+  }
+  reads
+}
+
+#[test]
+fn test_checkpoint_restores_wrapper_state() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let path = env::temp_dir().join(format!("dram_checkpoint_{}.bin", std::process::id()));
+  let path = path.to_str().unwrap();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut forked = MemoryInterface::new_from_cwrapper_path()?;
+  let mut batch = CompletionBatch::new();
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(8, 1 << 12);
+    // Writes in flight, and completions left unpolled, at the checkpoint.
+    let mut written = 0;
+    while written < 64 {
+      let word = (written as u64 * 0x0101).to_le_bytes();
+      if memory
+        .submit(written * 8, true, Some(&word), None, std::ptr::null_mut())
+        .is_some()
+      {
+        written += 1;
+      }
+      memory.tick();
+    }
+    // Draining the writes in flight advances the clock.
+    let before = memory.cycle();
+    assert!(memory.checkpoint(path));
+    assert_eq!(memory.stats().outstanding, 0);
+    assert!(memory.cycle() > before);
+
+    forked.init(&config_path);
+    assert!(!forked.restore("/nonexistent/dram_checkpoint.bin"));
+    // A truncated checkpoint leaves the memory as it was.
+    forked.config_store(4, 16);
+    forked
+      .submit(3, true, Some(&[9; 4]), None, std::ptr::null_mut())
+      .unwrap();
+    drain(&forked);
+    let truncated = format!("{path}.truncated");
+    let bytes = std::fs::read(path)?;
+    std::fs::write(&truncated, &bytes[..bytes.len() - 1])?;
+    let (cycle, id) = (forked.cycle(), forked.next_request_id());
+    assert!(!forked.restore(&truncated));
+    std::fs::remove_file(&truncated)?;
+    assert_eq!((forked.cycle(), forked.next_request_id()), (cycle, id));
+    assert_eq!(forked.word_bytes(), 4);
+    let mut word = Vec::new();
+    forked.read_data(3, &mut word);
+    assert_eq!(word, [9; 4]);
+    assert_eq!(forked.stats().writes, 1);
+    assert!(forked.restore(path));
+    std::fs::remove_file(path)?;
+    assert_eq!(forked.word_bytes(), 8);
+    assert_eq!(forked.cycle(), memory.cycle());
+    assert_eq!(forked.memory_cycle(), memory.memory_cycle());
+    assert_eq!(forked.next_request_id(), memory.next_request_id());
+    let saved = forked.stats();
+    assert_eq!((saved.writes, saved.writes_completed), (64, 64));
+    assert_eq!(saved.latency_sum, memory.stats().latency_sum);
+
+    // The same completions are waiting on both sides.
+    forked.poll_completions(&mut batch, 64);
+    let pending: Vec<u64> = batch.iter().map(|(done, _)| done.id).collect();
+    memory.poll_completions(&mut batch, 64);
+    assert_eq!(pending, batch.iter().map(|(done, _)| done.id).collect::<Vec<_>>());
+    assert_eq!(pending.len(), 64);
+
+    // Both go on with the same data and IDs.
+    let reads = read_back(&memory, 512);
+    assert_eq!(read_back(&forked, 512), reads);
+    forked.read_data(5 * 8, &mut word);
+    assert_eq!(word, 0x0505u64.to_le_bytes());
+  }
+  Ok(())
+}
+
+/// Submits a polled request, ticking until the memory accepts it.
+unsafe fn submit_until_accepted(
+  memory: &MemoryInterface,
+  addr: i64,
+  is_write: bool,
+  data: Option<&[u8]>,
+) -> u64 {
+  loop {
+    if let Some(id) = memory.submit(addr, is_write, data, None, std::ptr::null_mut()) {
+      return id;
+    }
+    memory.tick();
+  }
+}
+
+/// Ticks until nothing is in flight, then takes every completion.
+unsafe fn drain(memory: &MemoryInterface) -> Vec<(Completion, Vec<u8>)> {
+  let mut batch = CompletionBatch::new();
+  let mut done = Vec::new();
+  while memory.next_event_cycle() != DRAM_NO_EVENT {
+    memory.tick();
+  }
+  while memory.poll_completions(&mut batch, 64) != 0 {
+    done.extend(batch.iter().map(|(c, data)| (*c, data.to_vec())));
+  }
+  done
+}
+
+#[test]
+fn test_coalescing_merges_requests_to_a_line() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(8, 1 << 12);
+    memory.set_coalescing(8, 4);
+
+    // Two writes to line 2 in one cycle: one transaction, both words stored.
+    let first = submit_until_accepted(&memory, 16, true, Some(&[0xaa; 8]));
+    let second = submit_until_accepted(&memory, 17, true, Some(&[0xbb; 8]));
+    assert_eq!(second, first + 1);
+    let writes = drain(&memory);
+    assert_eq!(writes.len(), 2);
+    assert_eq!(writes[0].0.cycle, writes[1].0.cycle);
+    assert_eq!(memory.stats().coalesced_writes, 1);
+
+    // A read of each word of the line: the first goes to the memory system,
+    // the others complete with it, in order, each with its own word.
+    let ids: Vec<u64> = (16..24)
+      .map(|addr| submit_until_accepted(&memory, addr, false, None))
+      .collect();
+    let reads = drain(&memory);
+    assert_eq!(reads.iter().map(|(c, _)| c.id).collect::<Vec<_>>(), ids);
+    assert!(reads.iter().all(|(c, _)| c.cycle == reads[0].0.cycle));
+    assert!(reads
+      .windows(2)
+      .all(|pair| pair[1].0.latency <= pair[0].0.latency));
+    assert_eq!(reads[0].1, [0xaa; 8]);
+    assert_eq!(reads[1].1, [0xbb; 8]);
+    assert_eq!(reads[2].1, [0; 8]);
+    let stats = memory.stats();
+    assert_eq!((stats.reads, stats.reads_completed, stats.coalesced_reads), (8, 8, 7));
+
+    // A write closes the line to the reads in flight before it.
+    submit_until_accepted(&memory, 32, false, None);
+    submit_until_accepted(&memory, 33, true, Some(&[1; 8]));
+    submit_until_accepted(&memory, 34, false, None);
+    drain(&memory);
+    assert_eq!(memory.stats().coalesced_reads, 7);
+
+    // Past the window, a write takes a transaction of its own.
+    submit_until_accepted(&memory, 40, true, None);
+    memory.tick_n(5, false);
+    submit_until_accepted(&memory, 41, true, None);
+    drain(&memory);
+    assert_eq!(memory.stats().coalesced_writes, 1);
+
+    memory.set_coalescing(0, 0);
+    submit_until_accepted(&memory, 48, false, None);
+    submit_until_accepted(&memory, 49, false, None);
+    drain(&memory);
+    assert_eq!(memory.stats().coalesced_reads, 7);
+  }
+  Ok(())
+}
+
+#[test]
+fn test_fast_memory_completes_at_fixed_latencies() -> Result<(), Box<dyn std::error::Error>> {
+  let config = "FastMemory:\n  tCK: 0.5\n  read_latency: 10\n  write_latency: 6\n  \
+                row_size: 64\n  banks: 2\n  row_hit_latency: 3\n  queue_size: 4\n  \
+                requests_per_cycle: 2\n";
+  let mut memory = MemoryInterface::new_fast_from_cwrapper_path()?;
+
+  unsafe {
+    memory.init(config);
+    memory.config_store(8, 1 << 12);
+    assert_eq!(memory.get_memory_tCK(), 0.5);
+
+    // Two requests per cycle, then the rest of the cycle is refused.
+    let write = memory
+      .submit(0, true, Some(&[7; 8]), None, std::ptr::null_mut())
+      .unwrap();
+    // Row 0 of bank 0 is open now.
+    let hit = memory
+      .submit(1, false, None, None, std::ptr::null_mut())
+      .unwrap();
+    assert!(memory
+      .submit(128, false, None, None, std::ptr::null_mut())
+      .is_none());
+    memory.tick();
+    // Row 1 of bank 0: a miss. Row 0 of bank 1: a miss too.
+    let miss = memory
+      .submit(128, false, None, None, std::ptr::null_mut())
+      .unwrap();
+    let other_bank = memory
+      .submit(64, false, None, None, std::ptr::null_mut())
+      .unwrap();
+    memory.tick();
+    // Four in flight fill the queue.
+    assert!(memory
+      .submit(2, false, None, None, std::ptr::null_mut())
+      .is_none());
+
+    let done = drain(&memory);
+    let latency_of = |id: u64| done.iter().find(|(c, _)| c.id == id).unwrap().0.latency;
+    assert_eq!(latency_of(write), 6);
+    assert_eq!(latency_of(hit), 3);
+    assert_eq!(latency_of(miss), 10);
+    assert_eq!(latency_of(other_bank), 10);
+    let mut word = Vec::new();
+    memory.read_data(0, &mut word);
+    assert_eq!(word, [7; 8]);
+    let stats = memory.stats();
+    assert_eq!((stats.reads_completed, stats.writes_completed, stats.rejected), (3, 1, 2));
+  }
+  Ok(())
+}
+
+#[test]
+fn test_next_event_cycle_is_exact_on_fast_memory() -> Result<(), Box<dyn std::error::Error>> {
+  let config = "FastMemory:\n  tCK: 1.0\n  read_latency: 10\nPrefetcher:\n  impl: NextLine\n  \
+                line_size: 8\n  degree: 1\n  hit_latency: 4\n";
+  let mut memory = MemoryInterface::new_fast_from_cwrapper_path()?;
+  let mut batch = CompletionBatch::new();
+  let null = std::ptr::null_mut();
+
+  unsafe {
+    memory.init(config);
+    memory.config_store(8, 1 << 12);
+    // The read, and the prefetch of line 1 it triggers, are due 10 cycles on.
+    memory.submit(0, false, None, None, null).unwrap();
+    assert_eq!(memory.next_event_cycle(), 10);
+    assert_eq!(memory.skip_to(1_000), 10);
+    assert_eq!(memory.poll_completions(&mut batch, 16), 1);
+    assert_eq!(batch.iter().next().unwrap().0.cycle, 10);
+
+    // Served by the buffer, ahead of the prefetch of line 2.
+    memory.submit(8, false, None, None, null).unwrap();
+    assert_eq!(memory.next_event_cycle(), 14);
+    assert_eq!(memory.skip_to(1_000), 14);
+    // Only the prefetch is left, which nobody observes.
+    assert_eq!(memory.next_event_cycle(), DRAM_NO_EVENT);
+    memory.skip_to(100);
+    drain(&memory);
+
+    // Two core cycles per memory cycle.
+    memory.set_core_clock(0.5);
+    let start = memory.cycle();
+    memory.submit(1024, false, None, None, null).unwrap();
+    assert_eq!(memory.next_event_cycle(), start + 20);
+    assert_eq!(memory.skip_to(start + 1_000), start + 20);
+  }
+  Ok(())
+}
+
+#[test]
+fn test_detailed_windows_calibrate_the_model() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+  let mut fast = MemoryInterface::new_fast_from_cwrapper_path()?;
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(8, 1 << 12);
+    fast.init(&config_path);
+    assert!(!fast.set_detailed_windows(100, 50, 0));
+    assert!(!memory.set_detailed_windows(100, 0, 0));
+    assert!(!memory.set_detailed_windows(100, 60, 50));
+    assert!(!memory.set_detailed_windows(100, 100, 0));
+    assert!(memory.set_detailed_windows(100, 40, 10));
+
+    // Spaced-out reads all take the same latency in the memory system, so
+    // the model, calibrated on them, reproduces it outside the windows. One
+    // write, in the model's stretch, still reaches the store.
+    let write = 560;
+    for cycle in 0..1000 {
+      if cycle == write {
+        submit_until_accepted(&memory, 1000, true, Some(&[5; 8]));
+      } else if cycle % 8 == 0 {
+        submit_until_accepted(&memory, cycle as i64, false, None);
+      }
+      memory.tick();
+    }
+    let done = drain(&memory);
+    assert_eq!(done.len(), 125);
+    let reads: Vec<u32> = done
+      .iter()
+      .filter(|(c, _)| !c.is_write)
+      .map(|(c, _)| c.latency)
+      .collect();
+    assert!(reads.iter().all(|&latency| latency == reads[0]));
+    let mut word = Vec::new();
+    memory.read_data(1000, &mut word);
+    assert_eq!(word, [5; 8]);
+
+    let stats = memory.stats();
+    assert_eq!(stats.detailed_windows, 10);
+    // Draining ran into the next period's window.
+    let drained = stats.memory_cycle - 1000;
+    assert_eq!(stats.detailed_memory_cycles, 500 + drained.min(50));
+    assert_eq!(stats.est_latency_avg, f64::from(reads[0]));
+    assert_eq!(stats.est_latency_ci, 0.0);
+    assert!(stats.est_bandwidth > 0.0 && stats.est_bandwidth_ci.is_finite());
+
+    assert!(memory.set_detailed_windows(0, 0, 0));
+    assert_eq!(memory.stats().detailed_windows, 0);
+  }
+  Ok(())
+}
+
+#[test]
+fn test_decode_addr_follows_the_mapper() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let row_switches = |mapper: &str| -> Result<(Vec<i64>, u64), Box<dyn std::error::Error>> {
+    let memory = MemoryInterface::new_from_cwrapper_path()?;
+    unsafe {
+      memory.init_with_mapper(&config_path, mapper);
+      // 8 KiB apart: a row of ChRaBaRoCo, a rank of RoBaRaCoCh.
+      for i in 0..64 {
+        submit_until_accepted(&memory, i << 13, false, None);
+      }
+      drain(&memory);
+      Ok((memory.decode_addr(1 << 13), memory.stats().row_switches))
+    }
+  };
+
+  let memory = MemoryInterface::new_from_cwrapper_path()?;
+  unsafe {
+    memory.init(&config_path);
+    assert_eq!(memory.addr_levels(), ["channel", "rank", "bankgroup", "bank", "row", "column"]);
+    // RoBaRaCoCh, in 64-byte transactions: column, then rank, bank group,
+    // bank and row, from the low bits up.
+    assert_eq!(memory.decode_addr(1 << 6), [0, 0, 0, 0, 0, 1]);
+    assert_eq!(memory.decode_addr(1 << 13), [0, 1, 0, 0, 0, 0]);
+    assert_eq!(memory.decode_addr(3 << 14), [0, 0, 3, 0, 0, 0]);
+    assert_eq!(memory.decode_addr(1 << 16), [0, 0, 0, 1, 0, 0]);
+    assert_eq!(memory.decode_addr(5 << 18), [0, 0, 0, 0, 5, 0]);
+  }
+
+  // Striding by a row: RoBaRaCoCh spreads the rows over the 32 banks first,
+  // ChRaBaRoCo keeps them all in one bank.
+  let (decoded, interleaved) = row_switches("RoBaRaCoCh")?;
+  assert_eq!(decoded, [0, 1, 0, 0, 0, 0]);
+  assert_eq!(interleaved, 32);
+  let (decoded, conflicting) = row_switches("ChRaBaRoCo")?;
+  assert_eq!(decoded, [0, 0, 0, 0, 1, 0]);
+  assert_eq!(conflicting, 63);
+  Ok(())
+}
+
+#[test]
+fn test_channels_dispatch_and_merge_in_order() -> Result<(), Box<dyn std::error::Error>> {
+  let config = std::fs::read_to_string(example_config_path())?;
+  let run = |channels: &str| -> Result<(Vec<Completion>, u64), Box<dyn std::error::Error>> {
+    let memory = MemoryInterface::new_from_cwrapper_path()?;
+    unsafe {
+      memory.init(&format!("{}\n{}", config, channels));
+      for i in 0..64 {
+        submit_until_accepted(&memory, i * 64, false, None);
+      }
+      let done = drain(&memory).into_iter().map(|(c, _)| c).collect();
+      Ok((done, memory.cycle()))
+    }
+  };
+
+  let memory = MemoryInterface::new_from_cwrapper_path()?;
+  unsafe {
+    memory.init(&format!("{}\nChannels:\n  count: 4\n", config));
+    // 64-byte units go round the channels, then up the columns of each.
+    assert_eq!(memory.decode_addr(64), [1, 0, 0, 0, 0, 0]);
+    assert_eq!(memory.decode_addr(3 * 64), [3, 0, 0, 0, 0, 0]);
+    assert_eq!(memory.decode_addr(4 * 64), [0, 0, 0, 0, 0, 1]);
+  }
+
+  let (serial, serial_cycles) = run("")?;
+  let (one_thread, one_thread_cycles) = run("Channels:\n  count: 4\n  interleave: 64\n")?;
+  let (threads, threads_cycles) = run("Channels:\n  count: 4\n  threads: 4\n")?;
+  assert_eq!((serial.len(), one_thread.len()), (64, 64));
+  // Four controllers serve the stream about four times as fast.
+  assert!(
+    one_thread_cycles * 2 < serial_cycles,
+    "{} vs {}",
+    one_thread_cycles,
+    serial_cycles
+  );
+  // One ordered stream: by cycle, then by channel, whatever the threads.
+  let channel = |c: &Completion| (c.addr / 64) % 4;
+  assert!(one_thread
+    .windows(2)
+    .all(|w| (w[0].cycle, channel(&w[0])) <= (w[1].cycle, channel(&w[1]))));
+  let key = |done: &[Completion]| done.iter().map(|c| (c.id, c.cycle)).collect::<Vec<_>>();
+  assert_eq!(key(&one_thread), key(&threads));
+  assert_eq!(one_thread_cycles, threads_cycles);
+  Ok(())
+}
+
+#[test]
+fn test_peek_completions_borrows_the_queue() -> Result<(), Box<dyn std::error::Error>> {
+  let config_path = example_config_path();
+  let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+
+  unsafe {
+    memory.init(&config_path);
+    memory.config_store(64, 1 << 10);
+    memory
+      .submit(3, true, Some(&[5; 64]), None, std::ptr::null_mut())
+      .unwrap();
+    drain(&memory);
+    assert!(memory.peek_completions().is_empty());
+
+    // Past the initial ring capacity, so that the queue wraps around.
+    let mut ids = Vec::new();
+    for round in 0..3 {
+      for i in 0..100 {
+        ids.push(submit_until_accepted(&memory, 3 + i % 2, false, None));
+      }
+      while memory.next_event_cycle() != DRAM_NO_EVENT {
+        memory.tick();
+      }
+      let mut seen = Vec::new();
+      loop {
+        let done = memory.peek_completions();
+        if done.is_empty() {
+          break;
+        }
+        for (completion, data) in done.iter() {
+          let expected = if completion.addr == 3 {
+            [5; 64]
+          } else {
+            [0; 64]
+          };
+          assert_eq!(data, expected);
+          seen.push(completion.id);
+        }
+        // Still queued until released.
+        assert_eq!(memory.peek_completions().len(), done.len());
+        memory.release_completions(done.len());
+      }
+      seen.sort();
+      assert_eq!(seen, ids[round * 100..(round + 1) * 100]);
+    }
+  }
+  Ok(())
+}
+
+#[test]
+fn test_queue_free_slots_track_occupancy() -> Result<(), Box<dyn std::error::Error>> {
+  let config = std::fs::read_to_string(example_config_path())?;
+  let memory = MemoryInterface::new_from_cwrapper_path()?;
+
+  unsafe {
+    memory.init(&config);
+    assert_eq!(memory.num_channels(), 1);
+    let initial = memory.queue_free_slots();
+    assert!(initial > 0);
+    // A design that holds back on 0 sends no rejected request.
+    let mut sent = 0;
+    while memory.queue_free_slots() > 0 {
+      assert!(memory
+        .submit(sent * 64, false, None, None, std::ptr::null_mut())
+        .is_some());
+      sent += 1;
+      assert_eq!(memory.channel_occupancy(0), sent as u32);
+    }
+    assert!(sent >= initial as i64);
+    assert!(memory
+      .submit(sent * 64, false, None, None, std::ptr::null_mut())
+      .is_none());
+    assert_eq!(memory.stats().rejected, 1);
+    drain(&memory);
+    assert_eq!(memory.channel_occupancy(0), 0);
+    assert_eq!(memory.queue_free_slots() as i64, sent);
+  }
+
+  // Every channel is counted, in the numbering of `decode_addr`.
+  let memory = MemoryInterface::new_from_cwrapper_path()?;
+  unsafe {
+    memory.init(&format!("{}\nChannels:\n  count: 4\n", config));
+    assert_eq!(memory.num_channels(), 4);
+    for i in 0..6 {
+      submit_until_accepted(&memory, i * 64, false, None);
+    }
+    let occupancy: Vec<u32> = (0..5).map(|c| memory.channel_occupancy(c)).collect();
+    assert_eq!(occupancy, [2, 2, 1, 1, 0]);
+    drain(&memory);
+  }
+
+  // Exact for the fast memory: the tighter of its two limits.
+  let fast = MemoryInterface::new_fast_from_cwrapper_path()?;
+  unsafe {
+    fast.init("FastMemory:\n  queue_size: 3\n  requests_per_cycle: 2\n");
+    assert_eq!(fast.queue_free_slots(), 2);
+    submit_until_accepted(&fast, 0, false, None);
+    submit_until_accepted(&fast, 64, false, None);
+    assert_eq!(fast.queue_free_slots(), 0);
+    fast.tick();
+    assert_eq!(fast.queue_free_slots(), 1);
+    drain(&fast);
+    assert_eq!(fast.queue_free_slots(), 2);
+  }
+  Ok(())
+}
+
+#[test]
+fn test_reset_replays_like_a_new_instance() -> Result<(), Box<dyn std::error::Error>> {
+  let config = std::fs::read_to_string(example_config_path())?;
+  type Done = (u64, i64, u64, u32, Vec<u8>);
+  let run = |memory: &mut MemoryInterface| -> (Vec<Done>, u64) {
+    unsafe {
+      memory.config_store(8, 1 << 12);
+      for i in 0..48 {
+        submit_until_accepted(memory, i, i % 3 == 0, Some(&[i as u8; 8]));
+      }
+      let done = drain(memory)
+        .into_iter()
+        .map(|(c, data)| (c.id, c.addr, c.cycle, c.latency, data))
+        .collect();
+      (done, memory.cycle())
+    }
+  };
+
+  for (fast, text) in [
+    (false, config.clone()),
+    (false, format!("{}\nChannels:\n  count: 4\n", config)),
+    (true, "FastMemory:\n  queue_size: 8\n".to_string()),
+  ] {
+    let mut memory = if fast {
+      MemoryInterface::new_fast_from_cwrapper_path()?
+    } else {
+      MemoryInterface::new_from_cwrapper_path()?
+    };
+    let mut fresh = if fast {
+      MemoryInterface::new_fast_from_cwrapper_path()?
+    } else {
+      MemoryInterface::new_from_cwrapper_path()?
+    };
+    unsafe {
+      memory.init(&text);
+      fresh.init(&text);
+      memory.set_coalescing(8, 0);
+      let first = run(&mut memory);
+      assert_eq!(first.0.len(), 48);
+      assert!(memory.stats().coalesced_reads > 0);
+      // Left in flight, then dropped by the reset.
+      memory
+        .submit(0, false, None, None, std::ptr::null_mut())
+        .unwrap();
+      memory.reset();
+      assert_eq!((memory.cycle(), memory.next_request_id()), (0, 1));
+      let stats = memory.stats();
+      assert_eq!((stats.reads, stats.writes, stats.coalesced_reads), (0, 0, 0));
+      let mut word = Vec::new();
+      memory.read_data(0, &mut word);
+      assert_eq!(word, [0; 8]);
+
+      // Coalescing is off again, as in a new instance.
+      assert_eq!(run(&mut memory), run(&mut fresh));
+      assert_eq!(memory.stats().coalesced_reads, 0);
+    }
+  }
+  Ok(())
+}
+
+/// Prefetches the line after next, of the default 64 addresses, counting the calls in `ctx`, a
+/// `u32`.
+extern "C" fn skip_line_hook(addr: i64, out: *mut i64, max: u32, ctx: *mut c_void) -> u32 {
+  unsafe {
+    *(ctx as *mut u32) += 1;
+    if max > 0 {
+      *out = addr + 128;
+    }
+  }
+  max.min(1)
+}
+
+#[test]
+fn test_prefetcher_serves_streams_from_its_buffer() -> Result<(), Box<dyn std::error::Error>> {
+  // A read every 4 cycles walks a line of 8 words in 32 cycles, less than the 36 of a read.
+  let stream = |memory: &mut MemoryInterface| -> Vec<(u64, i64, u32, Vec<u8>)> {
+    unsafe {
+      memory.config_store(8, 1 << 12);
+      for i in 0..64 {
+        submit_until_accepted(memory, i, true, Some(&[i as u8; 8]));
+      }
+      drain(memory);
+      let mut done = Vec::new();
+      for i in 0..64 {
+        submit_until_accepted(memory, i, false, None);
+        memory.tick_n(4, false);
+      }
+      done.extend(
+        drain(memory)
+          .into_iter()
+          .map(|(c, data)| (c.id, c.addr, c.latency, data)),
+      );
+      done
+    }
+  };
+  let mut plain = MemoryInterface::new_fast_from_cwrapper_path()?;
+  let mut prefetching = MemoryInterface::new_fast_from_cwrapper_path()?;
+  unsafe {
+    plain.init("FastMemory:\n  read_latency: 36\n");
+    prefetching.init(
+      "FastMemory:\n  read_latency: 36\nPrefetcher:\n  impl: NextLine\n  line_size: 8\n  degree: 2\n",
+    );
+    let expected = stream(&mut plain);
+    let done = stream(&mut prefetching);
+    // Same IDs and data: only the latencies, and so the order, differ.
+    let strip = |done: &[(u64, i64, u32, Vec<u8>)]| {
+      done
+        .iter()
+        .map(|(id, addr, _, data)| (*id, *addr, data.clone()))
+        .collect::<std::collections::BTreeSet<_>>()
+    };
+    assert_eq!(strip(&done), strip(&expected));
+    for (_, addr, latency, data) in &done {
+      assert_eq!(data, &vec![*addr as u8; 8]);
+      assert!(*latency <= 36);
+    }
+    assert!(
+      done
+        .iter()
+        .filter(|(_, _, latency, _)| *latency == 1)
+        .count()
+        >= 40
+    );
+
+    // Line 1 was on its way when first read, the later ones had arrived.
+    let stats = prefetching.stats();
+    assert_eq!(stats.prefetches_late, 1);
+    assert!(stats.prefetches_useful >= 5);
+    assert_eq!(stats.prefetches_useless, 0);
+    assert!(stats.latency_avg < plain.stats().latency_avg);
+
+    // Lines 8 and 9 were prefetched and never read: the write to line 8 drops it.
+    let before = stats.prefetches_useless;
+    prefetching
+      .submit(64, true, Some(&[0; 8]), None, std::ptr::null_mut())
+      .unwrap();
+    assert_eq!(prefetching.stats().prefetches_useless, before + 1);
+
+    // A hook in place of the policy, on Ramulator2; gone after a reset.
+    let mut memory = MemoryInterface::new_from_cwrapper_path()?;
+    memory.init(&example_config_path());
+    let mut calls = 0u32;
+    memory.set_prefetch_hook(Some(skip_line_hook), &mut calls as *mut u32 as *mut c_void);
+    memory.config_store(8, 1 << 12);
+    submit_until_accepted(&memory, 0, false, None);
+    assert_eq!((calls, memory.stats().prefetches), (1, 1));
+    drain(&memory);
+    memory.reset();
+    submit_until_accepted(&memory, 0, false, None);
+    assert_eq!((calls, memory.stats().prefetches), (1, 0));
+  }
+  Ok(())
+}